@@ -0,0 +1,272 @@
+#define _POSIX_C_SOURCE 200809L
+#include "action.h"
+#include "transport.h"
+#include "clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+/* Lot en cours pour un hôte */
+typedef struct {
+    int host;
+    int tab;
+    remote_exec_t *exec;
+    double started;
+} action_batch_t;
+
+struct action_queue {
+    action_t *actions;
+    int count;
+    int cap;
+    int next_id;
+    action_batch_t *batches;
+    int batch_count;
+    int batch_cap;
+};
+
+action_queue_t *action_queue_new(void)
+{
+    action_queue_t *q = calloc(1, sizeof(action_queue_t));
+    if (!q) {
+        perror("calloc action queue");
+        return NULL;
+    }
+    q->next_id = 1;
+    return q;
+}
+
+void action_queue_free(action_queue_t *q)
+{
+    if (!q) return;
+    for (int b = 0; b < q->batch_count; ++b) {
+        remote_exec_cancel(q->batches[b].exec);
+    }
+    free(q->batches);
+    free(q->actions);
+    free(q);
+}
+
+/* Oublie les actions terminées depuis plus de ACTION_KEEP_S */
+static void prune(action_queue_t *q, double now)
+{
+    int n = 0;
+    for (int i = 0; i < q->count; ++i) {
+        const action_t *a = &q->actions[i];
+        int finished = (a->state == ACTION_OK || a->state == ACTION_FAILED);
+        if (finished && now - a->done_at > ACTION_KEEP_S) continue;
+        if (n != i) q->actions[n] = *a;
+        n++;
+    }
+    q->count = n;
+}
+
+static void finish(action_t *a, int code, double now)
+{
+    a->state = (code == 0) ? ACTION_OK : ACTION_FAILED;
+    a->code = code;
+    a->done_at = now;
+}
+
+int action_queue_signal(action_queue_t *q, int tab, int host, int pid, int signum)
+{
+    if (!q || !transport_signal_name(signum) || pid <= 0) return -1;
+
+    double now = now_seconds();
+    prune(q, now);
+
+    /* Touche répétée : la même action attend déjà son lot */
+    for (int i = 0; i < q->count; ++i) {
+        const action_t *a = &q->actions[i];
+        if (a->state == ACTION_PENDING && a->host == host && a->pid == pid && a->signum == signum) {
+            return a->id;
+        }
+    }
+
+    if (q->count == q->cap) {
+        int cap = q->cap ? q->cap * 2 : 16;
+        action_t *tmp = realloc(q->actions, (size_t)cap * sizeof(action_t));
+        if (!tmp) {
+            perror("realloc actions");
+            return -1;
+        }
+        q->actions = tmp;
+        q->cap = cap;
+    }
+
+    action_t *a = &q->actions[q->count++];
+    memset(a, 0, sizeof(*a));
+    a->id = q->next_id++;
+    a->tab = tab;
+    a->host = host;
+    a->pid = pid;
+    a->signum = signum;
+    a->state = ACTION_PENDING;
+
+    /* Local : kill() ne bloque pas */
+    if (host < 0) {
+        finish(a, kill(pid, signum) == 0 ? 0 : errno, now);
+    }
+    return a->id;
+}
+
+/* Résultats "@@rc ID CODE" du lot ; les actions sans ligne prennent le
+ * code de sortie de ssh */
+static void collect_batch(action_queue_t *q, const action_batch_t *b,
+                          const char *out, size_t len, int exit_code, double now)
+{
+    for (int i = 0; i < q->count; ++i) {
+        action_t *a = &q->actions[i];
+        if (a->state != ACTION_RUNNING || a->host != b->host) continue;
+
+        int code = (exit_code == 0) ? 255 : exit_code;
+        char tag[32];
+        int tag_len = snprintf(tag, sizeof(tag), "@@rc %d ", a->id);
+        for (size_t p = 0; out && p + (size_t)tag_len <= len; ++p) {
+            if ((p == 0 || out[p - 1] == '\n') && memcmp(out + p, tag, (size_t)tag_len) == 0) {
+                code = atoi(out + p + tag_len);
+                break;
+            }
+        }
+        finish(a, code, now);
+    }
+}
+
+static void fail_running(action_queue_t *q, int host, int code, double now)
+{
+    for (int i = 0; i < q->count; ++i) {
+        action_t *a = &q->actions[i];
+        if (a->state == ACTION_RUNNING && a->host == host) finish(a, code, now);
+    }
+}
+
+static int host_busy(const action_queue_t *q, int host)
+{
+    for (int b = 0; b < q->batch_count; ++b) {
+        if (q->batches[b].host == host) return 1;
+    }
+    return 0;
+}
+
+/* Un lot : toutes les actions en attente de l'hôte, dans une commande */
+static void start_batch(action_queue_t *q, remote_inventory_t *inv, int host, double now)
+{
+    remote_signal_t sigs[ACTION_MAX_BATCH];
+    int tab = -1, n = 0;
+
+    /* Hôte en backoff : inutile de payer le timeout de connexion */
+    int down = (host >= (int)inv->count || !remote_health_due(&inv->machines[host].health));
+
+    for (int i = 0; i < q->count && n < ACTION_MAX_BATCH; ++i) {
+        action_t *a = &q->actions[i];
+        if (a->state != ACTION_PENDING || a->host != host) continue;
+        if (down) {
+            finish(a, ACTION_ERR_HOST_DOWN, now);
+            continue;
+        }
+        sigs[n].id = a->id;
+        sigs[n].pid = a->pid;
+        sigs[n].signum = a->signum;
+        a->state = ACTION_RUNNING;
+        tab = a->tab;
+        n++;
+    }
+    if (n == 0) return;
+
+    if (q->batch_count == q->batch_cap) {
+        int cap = q->batch_cap ? q->batch_cap * 2 : 4;
+        action_batch_t *tmp = realloc(q->batches, (size_t)cap * sizeof(action_batch_t));
+        if (!tmp) {
+            perror("realloc action batches");
+            fail_running(q, host, 255, now);
+            return;
+        }
+        q->batches = tmp;
+        q->batch_cap = cap;
+    }
+
+    remote_exec_t *e = remote_signal_start(&inv->machines[host], sigs, n);
+    if (!e) {
+        fail_running(q, host, 255, now);
+        return;
+    }
+    action_batch_t *b = &q->batches[q->batch_count++];
+    b->host = host;
+    b->tab = tab;
+    b->exec = e;
+    b->started = now;
+}
+
+int action_queue_pump(action_queue_t *q, remote_inventory_t *inv, int *done, int max)
+{
+    if (!q) return 0;
+    double now = now_seconds();
+    int ndone = 0;
+
+    for (int i = 0; i < q->batch_count; ) {
+        action_batch_t *b = &q->batches[i];
+        int r = remote_exec_poll(b->exec);
+
+        if (r == 0 && now - b->started < ACTION_TIMEOUT_S) {
+            ++i;
+            continue;
+        }
+        if (r > 0) {
+            char *out;
+            size_t len;
+            int code = remote_exec_finish(b->exec, &out, &len);
+            collect_batch(q, b, out, len, code, now);
+            free(out);
+        } else {
+            remote_exec_cancel(b->exec);
+            fail_running(q, b->host, r < 0 ? 255 : ACTION_ERR_TIMEOUT, now);
+        }
+        if (ndone < max) done[ndone++] = b->tab;
+        q->batches[i] = q->batches[--q->batch_count];
+    }
+
+    for (int i = 0; i < q->count; ++i) {
+        const action_t *a = &q->actions[i];
+        if (a->state == ACTION_PENDING && a->host >= 0 && !host_busy(q, a->host)) {
+            start_batch(q, inv, a->host, now);
+        }
+    }
+    return ndone;
+}
+
+int action_queue_describe(const action_queue_t *q, int tab, char *buf, size_t size)
+{
+    if (size > 0) buf[0] = '\0';
+    if (!q || size == 0) return 0;
+
+    double now = now_seconds();
+    size_t off = 0;
+    int shown = 0;
+    for (int i = q->count - 1; i >= 0 && off + 1 < size; --i) {
+        const action_t *a = &q->actions[i];
+        if (tab >= 0 && a->tab != tab) continue;
+        int finished = (a->state == ACTION_OK || a->state == ACTION_FAILED);
+        if (finished && now - a->done_at > ACTION_KEEP_S) continue;
+
+        char status[32];
+        switch (a->state) {
+        case ACTION_PENDING: snprintf(status, sizeof(status), "queued");  break;
+        case ACTION_RUNNING: snprintf(status, sizeof(status), "sending"); break;
+        case ACTION_OK:      snprintf(status, sizeof(status), "ok");      break;
+        default:
+            if (a->code == ACTION_ERR_TIMEOUT)        snprintf(status, sizeof(status), "timeout");
+            else if (a->code == ACTION_ERR_HOST_DOWN) snprintf(status, sizeof(status), "host down");
+            else if (a->host < 0)                     snprintf(status, sizeof(status), "%s", strerror(a->code));
+            else if (a->code == 255)                  snprintf(status, sizeof(status), "ssh failed");
+            else                                      snprintf(status, sizeof(status), "failed (%d)", a->code);
+            break;
+        }
+        off += (size_t)snprintf(buf + off, size - off, "%s%s %d %s",
+                                shown ? " | " : "", transport_signal_name(a->signum), a->pid, status);
+        shown++;
+    }
+    if (off >= size) buf[size - 1] = '\0';
+    return shown;
+}
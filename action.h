@@ -0,0 +1,61 @@
+#ifndef ACTION_H
+#define ACTION_H
+
+#include <stddef.h>
+#include "network.h"
+
+/*
+ * File d'actions sur les processus (signaux F5-F8). Une action locale
+ * est exécutée tout de suite ; les actions distantes attendent dans la
+ * file et partent par lots, une seule commande par hôte pour toutes
+ * celles en attente, lue sans bloquer l'UI. Une action identique à une
+ * autre encore en attente lui est fusionnée.
+ */
+
+#define ACTION_TIMEOUT_S 20.0   /* lot sans réponse (hôte figé) : abandonné */
+#define ACTION_KEEP_S    10.0   /* actions terminées encore affichées */
+#define ACTION_MAX_BATCH 32
+
+/* Codes d'échec sans code de sortie distant */
+#define ACTION_ERR_TIMEOUT   (-1)
+#define ACTION_ERR_HOST_DOWN (-2)
+
+typedef enum {
+    ACTION_PENDING = 0,
+    ACTION_RUNNING,
+    ACTION_OK,
+    ACTION_FAILED
+} action_state_t;
+
+typedef struct {
+    int id;
+    int tab;                    /* onglet de l'hôte visé */
+    int host;                   /* index dans l'inventaire, -1 = local */
+    int pid;
+    int signum;
+    action_state_t state;
+    int code;                   /* FAILED : sortie de kill ou de ssh, errno en local, ACTION_ERR_* */
+    double done_at;             /* horloge monotone, en secondes */
+} action_t;
+
+typedef struct action_queue action_queue_t;
+
+action_queue_t *action_queue_new(void);
+
+/* Les lots en cours sont abandonnés */
+void action_queue_free(action_queue_t *q);
+
+/* Ajoute un signal (host -1 : envoyé tout de suite par kill()).
+ * Retourne l'id de l'action, -1 si le signal n'est pas supporté. */
+int action_queue_signal(action_queue_t *q, int tab, int host, int pid, int signum);
+
+/* Récolte les lots terminés et lance ceux en attente. Les onglets dont
+ * un lot vient de finir sont écrits dans done (au plus max) ; retourne
+ * leur nombre. */
+int action_queue_pump(action_queue_t *q, remote_inventory_t *inv, int *done, int max);
+
+/* Actions récentes de l'onglet (tab < 0 : toutes), les plus récentes
+ * d'abord. Retourne 0 s'il n'y en a aucune. */
+int action_queue_describe(const action_queue_t *q, int tab, char *buf, size_t size);
+
+#endif
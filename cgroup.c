@@ -0,0 +1,168 @@
+#define _POSIX_C_SOURCE 200809L
+#include "cgroup.h"
+#include "clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+/* Table des cgroups : l'id est index + 1 */
+static cgroup_info_t *cgroups;
+static int cgroup_count;
+static int cgroup_cap;
+
+static int *slots;          /* hash chemin -> index, -1 = vide */
+static size_t slot_cap;
+
+static unsigned int generation;
+
+static unsigned long hash_path(const char *s)
+{
+    /* FNV-1a */
+    unsigned long h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int rehash(size_t newcap)
+{
+    int *tmp = malloc(newcap * sizeof(int));
+    if (!tmp) return -1;
+    for (size_t i = 0; i < newcap; ++i) tmp[i] = -1;
+
+    for (int i = 0; i < cgroup_count; ++i) {
+        size_t h = hash_path(cgroups[i].path) & (newcap - 1);
+        while (tmp[h] != -1) h = (h + 1) & (newcap - 1);
+        tmp[h] = i;
+    }
+
+    free(slots);
+    slots = tmp;
+    slot_cap = newcap;
+    return 0;
+}
+
+static int intern(const char *full)
+{
+    /* Clé tronquée comme le chemin stocké, sinon un chemin long ne
+     * retrouverait jamais son entrée */
+    char path[CGROUP_PATH_MAX];
+    snprintf(path, sizeof(path), "%s", full);
+
+    if ((size_t)(cgroup_count + 1) * 2 > slot_cap) {
+        if (rehash(slot_cap ? slot_cap * 2 : 64) != 0) return 0;
+    }
+
+    size_t mask = slot_cap - 1;
+    size_t h = hash_path(path) & mask;
+    while (slots[h] != -1) {
+        if (strcmp(cgroups[slots[h]].path, path) == 0) return slots[h] + 1;
+        h = (h + 1) & mask;
+    }
+
+    if (cgroup_count >= cgroup_cap) {
+        int newcap = cgroup_cap ? cgroup_cap * 2 : 32;
+        cgroup_info_t *tmp = realloc(cgroups, (size_t)newcap * sizeof(cgroup_info_t));
+        if (!tmp) return 0;
+        cgroups = tmp;
+        cgroup_cap = newcap;
+    }
+
+    cgroup_info_t *cg = &cgroups[cgroup_count];
+    memset(cg, 0, sizeof(*cg));
+    memcpy(cg->path, path, sizeof(cg->path));
+    slots[h] = cgroup_count;
+    return ++cgroup_count;
+}
+
+void cgroup_begin_refresh(void)
+{
+    generation++;
+}
+
+int cgroup_lookup_pid(int pid)
+{
+    char fname[64];
+    snprintf(fname, sizeof(fname), "/proc/%d/cgroup", pid);
+
+    FILE *f = fopen(fname, "r");
+    if (!f) return 0;
+
+    /* Hiérarchie unifiée (v2) : ligne "0::/chemin" */
+    char line[600];
+    int id = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "0::", 3) != 0) continue;
+        line[strcspn(line, "\n")] = '\0';
+        id = intern(line + 3);
+        break;
+    }
+    fclose(f);
+
+    if (id > 0) cgroups[id - 1].used_gen = generation;
+    return id;
+}
+
+static void read_stats(cgroup_info_t *cg)
+{
+    char fname[600];
+    char line[128];
+    FILE *f;
+
+    unsigned long long usage = 0;
+    snprintf(fname, sizeof(fname), CGROUP_ROOT "%s/cpu.stat", cg->path);
+    f = fopen(fname, "r");
+    if (f) {
+        while (fgets(line, sizeof(line), f)) {
+            if (sscanf(line, "usage_usec %llu", &usage) == 1) break;
+        }
+        fclose(f);
+    }
+
+    snprintf(fname, sizeof(fname), CGROUP_ROOT "%s/memory.current", cg->path);
+    f = fopen(fname, "r");
+    if (f) {
+        if (fscanf(f, "%llu", &cg->memory_current) != 1) cg->memory_current = 0;
+        fclose(f);
+    }
+
+    double now = now_seconds();
+    if (cg->sampled_at > 0.0 && now > cg->sampled_at && usage >= cg->usage_usec) {
+        cg->cpu_pct = (double)(usage - cg->usage_usec) / ((now - cg->sampled_at) * 1e6) * 100.0;
+    } else {
+        cg->cpu_pct = 0.0;
+    }
+    cg->usage_usec = usage;
+    cg->sampled_at = now;
+}
+
+void cgroup_end_refresh(void)
+{
+    /* Une lecture par cgroup, quel que soit le nombre de PIDs membres */
+    for (int i = 0; i < cgroup_count; ++i) {
+        if (cgroups[i].used_gen == generation) {
+            read_stats(&cgroups[i]);
+        }
+    }
+}
+
+const cgroup_info_t *cgroup_get(int id)
+{
+    if (id <= 0 || id > cgroup_count) return NULL;
+    return &cgroups[id - 1];
+}
+
+void cgroup_cleanup(void)
+{
+    free(cgroups);
+    free(slots);
+    cgroups = NULL;
+    slots = NULL;
+    cgroup_count = cgroup_cap = 0;
+    slot_cap = 0;
+}
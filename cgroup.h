@@ -0,0 +1,31 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+/* cgroup v2 de la machine locale. Chaque chemin est interné une seule
+ * fois ; les processus ne gardent que l'identifiant (0 = inconnu). */
+
+/* Chemins plus longs tronqués (scopes kubepods / containerd) : tous les
+ * consommateurs les comparent à cette longueur */
+#define CGROUP_PATH_MAX 512
+
+typedef struct {
+    char path[CGROUP_PATH_MAX];
+    unsigned long long usage_usec;      /* cpu.stat */
+    unsigned long long memory_current;  /* memory.current, en octets */
+    double cpu_pct;                     /* delta usage / delta temps réel */
+    double sampled_at;
+    unsigned int used_gen;              /* dernier refresh où un PID y était */
+} cgroup_info_t;
+
+/* À appeler au début / à la fin de chaque collecte locale */
+void cgroup_begin_refresh(void);
+void cgroup_end_refresh(void);
+
+/* Lit /proc/<pid>/cgroup et retourne l'id interné du cgroup v2, 0 sinon */
+int cgroup_lookup_pid(int pid);
+
+const cgroup_info_t *cgroup_get(int id);
+
+void cgroup_cleanup(void);
+
+#endif
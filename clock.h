@@ -0,0 +1,7 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+/* Horloge monotone en secondes, pour les délais et les durées mesurées */
+double now_seconds(void);
+
+#endif
@@ -0,0 +1,167 @@
+#define _POSIX_C_SOURCE 200809L
+#include "columns.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Registre des colonnes, dans l'ordre d'affichage. Les colonnes étendues
+ * ne sont collectées que localement, et seulement si elles sont actives. */
+static const column_def_t columns[COL_COUNT] = {
+    [COL_PID]     = { "pid",     "PID",      8, PROC_NEED_STAT,    0, 0 },
+    [COL_USER]    = { "user",    "USER",    15, PROC_NEED_STAT,    0, 0 },
+    [COL_CPU]     = { "cpu",     "%CPU",     6, PROC_NEED_STAT,    0, 0 },
+    [COL_MEM]     = { "mem",     "%MEM",     6, PROC_NEED_STAT,    0, 0 },
+    [COL_STATE]   = { "state",   "S",        2, PROC_NEED_STAT,    0, 0 },
+    [COL_RSS]     = { "rss",     "RSS",      8, PROC_NEED_STAT,    0, 1 },
+    [COL_VSZ]     = { "vsz",     "VSZ",      8, PROC_NEED_STAT,    0, 1 },
+    [COL_PSS]     = { "pss",     "PSS",      8, PROC_NEED_SMAPS,   1, 1 },
+    [COL_USS]     = { "uss",     "USS",      8, PROC_NEED_SMAPS,   1, 1 },
+    [COL_SWAP]    = { "swap",    "SWAP",     8, PROC_NEED_SMAPS,   1, 1 },
+    [COL_NICE]    = { "nice",    "NI",       3, PROC_NEED_STAT,    0, 1 },
+    [COL_PRIO]    = { "prio",    "PRI",      3, PROC_NEED_STAT,    0, 1 },
+    [COL_START]   = { "start",   "START",    5, PROC_NEED_STAT,    0, 1 },
+    [COL_READ]    = { "read",    "READ",     8, PROC_NEED_IO,      0, 1 },
+    [COL_WRITE]   = { "write",   "WRITE",    8, PROC_NEED_IO,      0, 1 },
+    [COL_FDS]     = { "fds",     "FDS",      5, PROC_NEED_FD,      1, 1 },
+    [COL_COMMAND] = { "command", "COMMAND",  0, PROC_NEED_STAT,    0, 0 },
+    [COL_CMDLINE] = { "cmdline", "CMDLINE",  0, PROC_NEED_CMDLINE, 1, 1 },
+};
+
+const column_def_t *column_def(column_id_t id)
+{
+    if ((int)id < 0 || id >= COL_COUNT) return NULL;
+    return &columns[id];
+}
+
+int columns_parse(const char *list, unsigned long *mask)
+{
+    char buf[256];
+    strncpy(buf, list, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    unsigned long m = 0;
+    char *saveptr = NULL;
+    for (char *tok = strtok_r(buf, ",", &saveptr);
+         tok != NULL;
+         tok = strtok_r(NULL, ",", &saveptr)) {
+        int found = 0;
+        for (int i = 0; i < COL_COUNT; ++i) {
+            if (strcmp(tok, columns[i].name) == 0) {
+                m |= COL_BIT(i);
+                found = 1;
+                break;
+            }
+        }
+        if (!found) return -1;
+    }
+
+    /* Le PID sert à la sélection et aux signaux : toujours affiché */
+    *mask = m | COL_BIT(COL_PID);
+    return 0;
+}
+
+unsigned columns_needs(unsigned long mask, int visible_only)
+{
+    unsigned needs = 0;
+    for (int i = 0; i < COL_COUNT; ++i) {
+        if ((mask & COL_BIT(i)) && columns[i].visible_only == visible_only) {
+            needs |= columns[i].needs;
+        }
+    }
+    return needs;
+}
+
+/* Cellules cadrées à gauche (texte) ou à droite (nombres). Une colonne de
+ * largeur libre suivie d'une autre est tronquée à la longueur de comm. */
+static size_t append_cell(char *buf, size_t size, size_t off,
+                          unsigned long mask, int id, const char *text)
+{
+    if (off >= size) return off;
+    const column_def_t *c = &columns[id];
+    int width = c->width;
+    int precision = (int)(size - off);
+    if (width == 0 && (mask >> (id + 1)) != 0) width = precision = 15;
+
+    int left = (c->width == 0 || id == COL_PID || id == COL_USER);
+    off += (size_t)snprintf(buf + off, size - off, left ? "%-*.*s " : "%*.*s ",
+                            width, precision, text);
+    return off;
+}
+
+void columns_format_header(unsigned long mask, char *buf, size_t size)
+{
+    size_t off = 0;
+    buf[0] = '\0';
+
+    for (int i = 0; i < COL_COUNT; ++i) {
+        if (mask & COL_BIT(i)) off = append_cell(buf, size, off, mask, i, columns[i].header);
+    }
+}
+
+void columns_format_row(unsigned long mask, const process_info_t *p, char *buf, size_t size)
+{
+    char cell[256];
+    size_t off = 0;
+    buf[0] = '\0';
+
+    for (int i = 0; i < COL_COUNT; ++i) {
+        if (!(mask & COL_BIT(i))) continue;
+        column_format((column_id_t)i, p, cell, sizeof(cell));
+        off = append_cell(buf, size, off, mask, i, cell);
+    }
+}
+
+/* 12345678 -> "12345K", "1234M"... pour tenir dans 8 caractères */
+static void format_kb(unsigned long long kb, char *buf, size_t size)
+{
+    if (kb < 100000ULL)          snprintf(buf, size, "%lluK", kb);
+    else if (kb < 100000000ULL)  snprintf(buf, size, "%lluM", kb / 1024);
+    else                         snprintf(buf, size, "%lluG", kb / (1024 * 1024));
+}
+
+void column_format(column_id_t id, const process_info_t *p, char *buf, size_t size)
+{
+    const column_def_t *c = column_def(id);
+    if (!c) {
+        buf[0] = '\0';
+        return;
+    }
+
+    /* Colonnes étendues non collectées pour cette ligne (onglet distant,
+     * ou colonne coûteuse d'une ligne pas encore affichée) */
+    if (c->extended && !(p->filled & c->needs)) {
+        snprintf(buf, size, "-");
+        return;
+    }
+
+    switch (id) {
+    case COL_PID:     snprintf(buf, size, "%d", p->pid); break;
+    case COL_USER:    snprintf(buf, size, "%s", p->user); break;
+    case COL_CPU:     snprintf(buf, size, "%.2f", p->cpu_usage); break;
+    case COL_MEM:     snprintf(buf, size, "%.2f", p->mem_usage); break;
+    case COL_STATE:   snprintf(buf, size, "%c", p->state ? p->state : ' '); break;
+    case COL_RSS:     format_kb(p->rss_kb, buf, size); break;
+    case COL_VSZ:     format_kb(p->vsz_kb, buf, size); break;
+    case COL_PSS:     format_kb(p->pss_kb, buf, size); break;
+    case COL_USS:     format_kb(p->uss_kb, buf, size); break;
+    case COL_SWAP:    format_kb(p->swap_kb, buf, size); break;
+    case COL_NICE:    snprintf(buf, size, "%d", p->nice); break;
+    case COL_PRIO:    snprintf(buf, size, "%d", p->priority); break;
+    case COL_READ:    format_kb(p->read_bytes / 1024, buf, size); break;
+    case COL_WRITE:   format_kb(p->write_bytes / 1024, buf, size); break;
+    case COL_FDS:     snprintf(buf, size, "%d", p->fd_count); break;
+    case COL_COMMAND: snprintf(buf, size, "%s", p->command); break;
+    case COL_CMDLINE: snprintf(buf, size, "%s", p->cmdline[0] ? p->cmdline : p->command); break;
+    case COL_START: {
+        time_t t = (time_t)p->start_time;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        strftime(buf, size, "%H:%M", &tm);
+        break;
+    }
+    default:
+        buf[0] = '\0';
+        break;
+    }
+}
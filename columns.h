@@ -0,0 +1,62 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include <stddef.h>
+#include "process.h"
+
+typedef enum {
+    COL_PID = 0,
+    COL_USER,
+    COL_CPU,
+    COL_MEM,
+    COL_STATE,
+    COL_RSS,
+    COL_VSZ,
+    COL_PSS,
+    COL_USS,
+    COL_SWAP,
+    COL_NICE,
+    COL_PRIO,
+    COL_START,
+    COL_READ,
+    COL_WRITE,
+    COL_FDS,
+    COL_COMMAND,
+    COL_CMDLINE,
+    COL_COUNT
+} column_id_t;
+
+#define COL_BIT(id) (1UL << (id))
+
+/* Mémoire détaillée, affichée / masquée par la touche m */
+#define COLUMNS_MEM_DETAIL (COL_BIT(COL_PSS) | COL_BIT(COL_USS) | COL_BIT(COL_SWAP))
+
+/* Colonnes affichées par défaut (celles de ps -eo pid,user,pcpu,pmem,stat,comm) */
+#define COLUMNS_DEFAULT (COL_BIT(COL_PID) | COL_BIT(COL_USER) | COL_BIT(COL_CPU) | \
+                         COL_BIT(COL_MEM) | COL_BIT(COL_STATE) | COL_BIT(COL_COMMAND))
+
+typedef struct {
+    const char *name;       /* nom pour --columns */
+    const char *header;
+    int width;              /* 0 = dernière colonne, largeur libre */
+    unsigned needs;         /* fichiers /proc requis (PROC_NEED_*) */
+    int visible_only;       /* coûteux : calculé pour les lignes affichées seulement */
+    int extended;           /* absente de la sortie ps des hôtes distants */
+} column_def_t;
+
+const column_def_t *column_def(column_id_t id);
+
+/* "pid,user,cpu,rss,fds,cmdline" -> masque de colonnes. -1 si nom inconnu. */
+int columns_parse(const char *list, unsigned long *mask);
+
+/* Fichiers à lire pour les colonnes actives, pendant la collecte
+ * (visible_only = 0) ou pour les lignes affichées (visible_only = 1) */
+unsigned columns_needs(unsigned long mask, int visible_only);
+
+void columns_format_header(unsigned long mask, char *buf, size_t size);
+void columns_format_row(unsigned long mask, const process_info_t *p, char *buf, size_t size);
+
+/* Valeur d'une cellule, "-" si non collectée (ex. onglet distant) */
+void column_format(column_id_t id, const process_info_t *p, char *buf, size_t size);
+
+#endif
@@ -0,0 +1,603 @@
+/* struct ucred (SO_PEERCRED) */
+#define _GNU_SOURCE
+#include "daemon.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+void daemon_socket_path(char *buf, size_t size)
+{
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    if (dir && dir[0] != '\0') {
+        snprintf(buf, size, "%s/process_manager.sock", dir);
+    } else {
+        snprintf(buf, size, "/tmp/process_manager-%u.sock", (unsigned)getuid());
+    }
+}
+
+static int make_address(const char *path, struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return -1;
+    }
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+/* Pas de fuite de la socket dans les ssh lancés par fork */
+static int open_socket(void)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
+
+/* Le chemin par défaut peut être dans /tmp, où n'importe qui peut créer
+ * le nom avant nous. 1 : socket à nous, 0 : absente, -1 : autre chose
+ * (propriétaire différent, fichier ordinaire, lien) */
+static int socket_owned(const char *path)
+{
+    struct stat st;
+    if (lstat(path, &st) != 0) return errno == ENOENT ? 0 : -1;
+    return (S_ISSOCK(st.st_mode) && st.st_uid == getuid()) ? 1 : -1;
+}
+
+/* L'autre bout de la connexion tourne-t-il sous notre uid ? */
+static int peer_is_me(int fd)
+{
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return 0;
+    return cred.uid == getuid();
+}
+
+static void set_nonblock(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/* --- Démon --- */
+
+typedef struct {
+    int fd;                     /* -1 = déconnecté, retiré au prochain poll */
+    int out_fd;                 /* fd sauf pour le relais (stdin / stdout) */
+    unsigned char *out;         /* données en attente d'envoi */
+    size_t off;
+    size_t len;
+    size_t cap;
+    char req[64];               /* requête "K ..." incomplète */
+    size_t req_len;
+} viewer_t;
+
+typedef struct {
+    int tab;
+    int pid;
+    int signum;
+} daemon_signal_t;
+
+struct daemon_server {
+    int listen_fd;
+    char path[108];
+    unsigned char *header;
+    size_t header_len;
+
+    record_codec_t *codec;
+    long long *last_ts;         /* date du dernier snapshot de chaque onglet */
+    int tab_count;
+
+    viewer_t *viewers;
+    int viewer_count;
+
+    daemon_signal_t signals[DAEMON_MAX_SIGNALS];   /* reçus, pas encore pris */
+    int signal_count;
+};
+
+static void viewer_drop(viewer_t *v)
+{
+    if (v->out_fd >= 0 && v->out_fd != v->fd) close(v->out_fd);
+    if (v->fd >= 0) close(v->fd);
+    v->fd = -1;
+    v->out_fd = -1;
+    free(v->out);
+    v->out = NULL;
+    v->off = v->len = v->cap = 0;
+}
+
+/* Envoie ce qui est en attente ; le reste attend POLLOUT */
+static void viewer_flush(viewer_t *v)
+{
+    while (v->fd >= 0 && v->off < v->len) {
+        /* Sortie du relais : un tube, SIGPIPE est ignoré par l'appelant */
+        ssize_t n = (v->out_fd == v->fd)
+                  ? send(v->fd, v->out + v->off, v->len - v->off, MSG_NOSIGNAL | MSG_DONTWAIT)
+                  : write(v->out_fd, v->out + v->off, v->len - v->off);
+        if (n > 0) {
+            v->off += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            viewer_drop(v);
+            return;
+        }
+    }
+    v->off = v->len = 0;
+}
+
+static void viewer_queue(viewer_t *v, const unsigned char *data, size_t len)
+{
+    if (v->fd < 0) return;
+
+    if (v->off > 0 && v->off == v->len) v->off = v->len = 0;
+    if (v->len - v->off + len > DAEMON_MAX_PENDING) {
+        /* Lecteur bloqué : il recevra un keyframe s'il se reconnecte */
+        viewer_drop(v);
+        return;
+    }
+    if (v->len + len > v->cap) {
+        if (v->off > 0) {
+            memmove(v->out, v->out + v->off, v->len - v->off);
+            v->len -= v->off;
+            v->off = 0;
+        }
+        size_t newcap = v->cap ? v->cap : 64 * 1024;
+        while (newcap < v->len + len) newcap *= 2;
+        unsigned char *tmp = realloc(v->out, newcap);
+        if (!tmp) {
+            viewer_drop(v);
+            return;
+        }
+        v->out = tmp;
+        v->cap = newcap;
+    }
+    memcpy(v->out + v->len, data, len);
+    v->len += len;
+    viewer_flush(v);
+}
+
+static daemon_server_t *server_new(const record_tab_t *tabs, int tab_count)
+{
+    daemon_server_t *s = calloc(1, sizeof(daemon_server_t));
+    if (!s) {
+        perror("calloc daemon");
+        return NULL;
+    }
+    s->listen_fd = -1;
+    s->tab_count = tab_count;
+    s->codec = record_codec_new(tab_count);
+    s->last_ts = calloc((size_t)(tab_count > 0 ? tab_count : 1), sizeof(long long));
+    s->header = record_header_encode(tabs, tab_count, &s->header_len);
+    if (!s->codec || !s->last_ts || !s->header) {
+        perror("daemon");
+        daemon_close(s);
+        return NULL;
+    }
+    return s;
+}
+
+/* Ajoute un lecteur et lui envoie les onglets, puis l'état courant de chacun */
+static void add_viewer(daemon_server_t *s, int fd, int out_fd)
+{
+    viewer_t *tmp = realloc(s->viewers, (size_t)(s->viewer_count + 1) * sizeof(viewer_t));
+    if (!tmp) {
+        close(fd);
+        if (out_fd != fd) close(out_fd);
+        return;
+    }
+    s->viewers = tmp;
+    viewer_t *v = &s->viewers[s->viewer_count++];
+    memset(v, 0, sizeof(*v));
+    v->fd = fd;
+    v->out_fd = out_fd;
+
+    viewer_queue(v, s->header, s->header_len);
+    for (int t = 0; t < s->tab_count; ++t) {
+        const unsigned char *frame;
+        size_t len;
+        if (s->last_ts[t] == 0) continue;
+        if (record_codec_keyframe(s->codec, t, s->last_ts[t], &frame, &len) == 0) {
+            viewer_queue(v, frame, len);
+        }
+    }
+}
+
+daemon_server_t *daemon_listen(const char *path, const record_tab_t *tabs, int tab_count)
+{
+    struct sockaddr_un addr;
+    if (make_address(path, &addr) != 0) return NULL;
+
+    if (socket_owned(path) < 0) {
+        fprintf(stderr, "%s: exists and is not our socket, refusing to use it\n", path);
+        return NULL;
+    }
+
+    /* Socket déjà servie ? Sinon c'est un reste d'un démon arrêté */
+    int probe = open_socket();
+    if (probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        close(probe);
+        fprintf(stderr, "%s: a daemon is already running\n", path);
+        return NULL;
+    }
+    if (probe >= 0) close(probe);
+    unlink(path);
+
+    daemon_server_t *s = server_new(tabs, tab_count);
+    if (!s) return NULL;
+    snprintf(s->path, sizeof(s->path), "%s", path);
+
+    s->listen_fd = open_socket();
+    if (s->listen_fd < 0) {
+        perror("socket");
+        daemon_close(s);
+        return NULL;
+    }
+
+    /* Socket accessible au seul utilisateur */
+    mode_t old = umask(077);
+    int rc = bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old);
+    if (rc != 0 || listen(s->listen_fd, 16) != 0) {
+        perror(path);
+        close(s->listen_fd);
+        s->listen_fd = -1;
+        daemon_close(s);
+        return NULL;
+    }
+    set_nonblock(s->listen_fd);
+    return s;
+}
+
+daemon_server_t *daemon_serve_stdio(const record_tab_t *tabs, int tab_count)
+{
+    daemon_server_t *s = server_new(tabs, tab_count);
+    if (!s) return NULL;
+
+    /* Le lecteur est à l'autre bout de ssh : une écriture sur un tube
+     * fermé doit échouer, pas tuer le relais */
+    signal(SIGPIPE, SIG_IGN);
+    set_nonblock(STDIN_FILENO);
+    set_nonblock(STDOUT_FILENO);
+    add_viewer(s, STDIN_FILENO, STDOUT_FILENO);
+    return s;
+}
+
+void daemon_close(daemon_server_t *s)
+{
+    if (!s) return;
+    for (int i = 0; i < s->viewer_count; ++i) {
+        viewer_drop(&s->viewers[i]);
+    }
+    free(s->viewers);
+    if (s->listen_fd >= 0) {
+        close(s->listen_fd);
+        unlink(s->path);
+    }
+    record_codec_free(s->codec);
+    free(s->last_ts);
+    free(s->header);
+    free(s);
+}
+
+int daemon_viewer_count(const daemon_server_t *s)
+{
+    return s ? s->viewer_count : 0;
+}
+
+void daemon_publish(daemon_server_t *s, int tab, long long ts_ms,
+                    const process_info_t *procs, int count)
+{
+    if (!s || tab < 0 || tab >= s->tab_count) return;
+
+    /* Encodé une fois, quel que soit le nombre de lecteurs */
+    const unsigned char *frame;
+    size_t len;
+    if (record_codec_encode(s->codec, tab, ts_ms, procs, count, &frame, &len) != 0) {
+        return;
+    }
+    s->last_ts[tab] = ts_ms;
+    for (int i = 0; i < s->viewer_count; ++i) {
+        viewer_queue(&s->viewers[i], frame, len);
+    }
+}
+
+static void accept_viewers(daemon_server_t *s)
+{
+    for (;;) {
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) return;
+        /* La socket est en 0700 ; root excepté, personne d'autre n'arrive ici */
+        if (!peer_is_me(fd)) {
+            close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        set_nonblock(fd);
+        add_viewer(s, fd, fd);
+    }
+}
+
+/* Requêtes d'un lecteur : DAEMON_REQ_REFRESH, ou DAEMON_REQ_SIGNAL suivi
+ * de "tab pid signal\n". Retourne 1 si un rafraîchissement est demandé. */
+static int viewer_requests(daemon_server_t *s, viewer_t *v, const unsigned char *data, size_t n)
+{
+    int refresh = 0;
+    for (size_t k = 0; k < n; ++k) {
+        if (v->req_len == 0) {
+            if (data[k] == DAEMON_REQ_REFRESH) refresh = 1;
+            else if (data[k] == DAEMON_REQ_SIGNAL) v->req[v->req_len++] = (char)data[k];
+            continue;
+        }
+        if (data[k] != '\n') {
+            /* Requête trop longue : ignorée */
+            if (v->req_len < sizeof(v->req) - 1) v->req[v->req_len++] = (char)data[k];
+            continue;
+        }
+
+        v->req[v->req_len] = '\0';
+        v->req_len = 0;
+        daemon_signal_t sig;
+        if (sscanf(v->req + 1, "%d %d %d", &sig.tab, &sig.pid, &sig.signum) == 3 &&
+            sig.tab >= 0 && sig.tab < s->tab_count && sig.pid > 0 &&
+            s->signal_count < DAEMON_MAX_SIGNALS) {
+            s->signals[s->signal_count++] = sig;
+        }
+    }
+    return refresh;
+}
+
+int daemon_poll(daemon_server_t *s, int timeout_ms)
+{
+    if (!s) return 0;
+
+    /* Deux entrées par lecteur : lecture, et écriture si elle passe par
+     * un autre fd (relais) ; poll() ignore les fd négatifs */
+    struct pollfd *pfd = calloc((size_t)s->viewer_count * 2 + 1, sizeof(struct pollfd));
+    if (!pfd) return 0;
+    pfd[0].fd = s->listen_fd;
+    pfd[0].events = POLLIN;
+    for (int i = 0; i < s->viewer_count; ++i) {
+        viewer_t *v = &s->viewers[i];
+        int pending = v->off < v->len;
+        int split = v->out_fd != v->fd;
+        pfd[2 * i + 1].fd = v->fd;
+        pfd[2 * i + 1].events = POLLIN | (pending && !split ? POLLOUT : 0);
+        pfd[2 * i + 2].fd = (pending && split) ? v->out_fd : -1;
+        pfd[2 * i + 2].events = POLLOUT;
+    }
+
+    int refresh = 0;
+    int n = poll(pfd, (nfds_t)s->viewer_count * 2 + 1, timeout_ms);
+    for (int i = 0; n > 0 && i < s->viewer_count; ++i) {
+        viewer_t *v = &s->viewers[i];
+        short re = pfd[2 * i + 1].revents;
+        short out_re = pfd[2 * i + 2].revents;
+        if ((re | out_re) & POLLOUT) viewer_flush(v);
+        if (out_re & (POLLHUP | POLLERR)) viewer_drop(v);
+        if (v->fd >= 0 && (re & (POLLIN | POLLHUP | POLLERR))) {
+            unsigned char req[64];
+            ssize_t r = read(v->fd, req, sizeof(req));
+            if (r <= 0 && !(r < 0 && (errno == EAGAIN || errno == EINTR))) {
+                viewer_drop(v);
+            }
+            if (r > 0 && viewer_requests(s, v, req, (size_t)r)) refresh = 1;
+        }
+    }
+    int accept_ready = n > 0 && (pfd[0].revents & POLLIN);
+    free(pfd);
+
+    /* Retire les lecteurs partis */
+    int k = 0;
+    for (int i = 0; i < s->viewer_count; ++i) {
+        if (s->viewers[i].fd >= 0) s->viewers[k++] = s->viewers[i];
+    }
+    s->viewer_count = k;
+
+    if (accept_ready) accept_viewers(s);
+    return refresh;
+}
+
+int daemon_take_signal(daemon_server_t *s, int *tab, int *pid, int *signum)
+{
+    if (!s || s->signal_count == 0) return 0;
+    *tab = s->signals[0].tab;
+    *pid = s->signals[0].pid;
+    *signum = s->signals[0].signum;
+    s->signal_count--;
+    memmove(s->signals, s->signals + 1, (size_t)s->signal_count * sizeof(daemon_signal_t));
+    return 1;
+}
+
+/* --- Lecteur --- */
+
+struct daemon_client {
+    int fd;
+    pid_t child;                /* ssh vers le relais, 0 pour une socket locale */
+    record_tab_t *tabs;
+    int tab_count;
+    record_codec_t *codec;
+
+    unsigned char *in;          /* octets reçus, pas encore décodés [off, len) */
+    size_t off;
+    size_t len;
+    size_t cap;
+};
+
+/* Lit ce qui est disponible. Retourne -1 si la connexion est fermée. */
+static int client_fill(daemon_client_t *c)
+{
+    if (c->off > 0) {
+        memmove(c->in, c->in + c->off, c->len - c->off);
+        c->len -= c->off;
+        c->off = 0;
+    }
+    if (c->cap - c->len < 64 * 1024) {
+        size_t newcap = c->cap ? c->cap * 2 : 256 * 1024;
+        unsigned char *tmp = realloc(c->in, newcap);
+        if (!tmp) return -1;
+        c->in = tmp;
+        c->cap = newcap;
+    }
+
+    ssize_t n = read(c->fd, c->in + c->len, c->cap - c->len);
+    if (n > 0) {
+        c->len += (size_t)n;
+        return 1;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    return -1;
+}
+
+daemon_client_t *daemon_attach(int fd, pid_t child, const char *what, int wait_ms)
+{
+    set_nonblock(fd);
+
+    daemon_client_t *c = calloc(1, sizeof(daemon_client_t));
+    if (!c) {
+        close(fd);
+        if (child > 0) {
+            kill(child, SIGTERM);
+            waitpid(child, NULL, 0);
+        }
+        return NULL;
+    }
+    c->fd = fd;
+    c->child = child;
+
+    /* L'entête est envoyé dès l'acceptation */
+    long hdr = 0;
+    for (int waited = 0; hdr == 0 && waited < wait_ms; ) {
+        int r = client_fill(c);
+        if (r < 0) break;
+        hdr = record_header_decode(c->in, c->len, &c->tabs, &c->tab_count);
+        if (hdr == 0 && r == 0) {
+            struct pollfd pfd = { .fd = fd, .events = POLLIN };
+            poll(&pfd, 1, 100);
+            waited += 100;
+        }
+    }
+    if (hdr <= 0) {
+        fprintf(stderr, "%s: no answer from the collector\n", what);
+        daemon_disconnect(c);
+        return NULL;
+    }
+    c->off = (size_t)hdr;
+
+    c->codec = record_codec_new(c->tab_count);
+    if (!c->codec) {
+        daemon_disconnect(c);
+        return NULL;
+    }
+    return c;
+}
+
+daemon_client_t *daemon_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    if (make_address(path, &addr) != 0) return NULL;
+
+    /* Un démon d'un autre utilisateur servirait de faux snapshots et
+     * recevrait nos signaux */
+    int owned = socket_owned(path);
+    if (owned < 0) fprintf(stderr, "%s: not our socket, ignored\n", path);
+    if (owned <= 0) return NULL;
+
+    int fd = open_socket();
+    if (fd < 0) return NULL;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return NULL;
+    }
+    if (!peer_is_me(fd)) {
+        fprintf(stderr, "%s: served by another user, ignored\n", path);
+        close(fd);
+        return NULL;
+    }
+    /* Démon local : l'entête arrive tout de suite, on l'attend au plus 2 s */
+    return daemon_attach(fd, 0, path, 2000);
+}
+
+void daemon_disconnect(daemon_client_t *c)
+{
+    if (!c) return;
+    /* ssh voit la fin de son entrée et ferme le relais */
+    if (c->fd >= 0) close(c->fd);
+    if (c->child > 0) {
+        kill(c->child, SIGTERM);
+        waitpid(c->child, NULL, 0);
+    }
+    record_codec_free(c->codec);
+    free(c->tabs);
+    free(c->in);
+    free(c);
+}
+
+const record_tab_t *daemon_client_tabs(const daemon_client_t *c, int *tab_count)
+{
+    *tab_count = c ? c->tab_count : 0;
+    return c ? c->tabs : NULL;
+}
+
+int daemon_client_next(daemon_client_t *c, int *tab, long long *ts_ms)
+{
+    if (!c || c->fd < 0) return -1;
+
+    for (;;) {
+        long size = record_frame_size(c->in + c->off, c->len - c->off);
+        if (size < 0) return -1;
+        if (size > 0) {
+            const unsigned char *frame = c->in + c->off;
+            c->off += (size_t)size;
+            if (record_codec_decode(c->codec, frame, (size_t)size, tab, ts_ms) != 0) return -1;
+            return 1;
+        }
+
+        int r = client_fill(c);
+        if (r <= 0) return r;
+    }
+}
+
+int daemon_client_rows(const daemon_client_t *c, int tab, process_info_t **out, int *count)
+{
+    *out = NULL;
+    const process_info_t *rows = record_codec_rows(c ? c->codec : NULL, tab, count);
+    if (*count == 0) return 0;
+
+    *out = malloc((size_t)*count * sizeof(process_info_t));
+    if (!*out) {
+        perror("malloc processes");
+        *count = 0;
+        return -1;
+    }
+    memcpy(*out, rows, (size_t)*count * sizeof(process_info_t));
+    return 0;
+}
+
+void daemon_client_request_refresh(daemon_client_t *c)
+{
+    if (!c || c->fd < 0) return;
+    /* Si le démon est arrêté, daemon_client_next() le signalera */
+    char req = DAEMON_REQ_REFRESH;
+    (void)send(c->fd, &req, 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+int daemon_client_send_signal(daemon_client_t *c, int tab, int pid, int signum)
+{
+    if (!c || c->fd < 0) return -1;
+    char req[64];
+    int len = snprintf(req, sizeof(req), "%c%d %d %d\n", DAEMON_REQ_SIGNAL, tab, pid, signum);
+    return send(c->fd, req, (size_t)len, MSG_NOSIGNAL | MSG_DONTWAIT) == len ? 0 : -1;
+}
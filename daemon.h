@@ -0,0 +1,86 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include "process.h"
+#include "record.h"
+
+/*
+ * Démon de collecte (--daemon) : une seule instance lit /proc et interroge
+ * les distants, les interfaces connectées sur la socket UNIX reçoivent les
+ * snapshots au format des enregistrements (entête des onglets, un keyframe
+ * par onglet à la connexion, puis les deltas).
+ *
+ * Un lecteur envoie un octet DAEMON_REQ_REFRESH pour demander une
+ * collecte immédiate, ou DAEMON_REQ_SIGNAL suivi de "tab pid signal\n"
+ * pour qu'un signal parte de la machine du démon.
+ *
+ * Relais (--relay) : le même flux, servi sur l'entrée / la sortie standard
+ * à un seul lecteur arrivé par ssh (--via). Sur un bastion, les sessions
+ * vers les hôtes restent locales ; une seule connexion longue distance
+ * porte les snapshots de tous, en deltas.
+ */
+
+#define DAEMON_REQ_REFRESH 'R'
+#define DAEMON_REQ_SIGNAL  'K'
+
+/* Signaux reçus et pas encore pris ; au-delà ils sont ignorés */
+#define DAEMON_MAX_SIGNALS 64
+
+/* Au-delà, un lecteur trop lent est déconnecté */
+#define DAEMON_MAX_PENDING (16u * 1024 * 1024)
+
+/* $XDG_RUNTIME_DIR/process_manager.sock, sinon /tmp/process_manager-UID.sock */
+void daemon_socket_path(char *buf, size_t size);
+
+typedef struct daemon_server daemon_server_t;
+
+/* Retourne NULL si la socket est déjà servie par un autre démon */
+daemon_server_t *daemon_listen(const char *path, const record_tab_t *tabs, int tab_count);
+void daemon_close(daemon_server_t *s);
+
+/* Relais : un seul lecteur, stdin / stdout. Quand il part, le nombre de
+ * lecteurs retombe à 0. */
+daemon_server_t *daemon_serve_stdio(const record_tab_t *tabs, int tab_count);
+
+int daemon_viewer_count(const daemon_server_t *s);
+
+/* Diffuse le snapshot brut d'un onglet à tous les lecteurs */
+void daemon_publish(daemon_server_t *s, int tab, long long ts_ms,
+                    const process_info_t *procs, int count);
+
+/* Accepte les lecteurs, envoie / lit ce qui est prêt, attend au plus
+ * timeout_ms. Retourne 1 si un lecteur a demandé un rafraîchissement. */
+int daemon_poll(daemon_server_t *s, int timeout_ms);
+
+/* Prochain signal demandé par un lecteur ; 0 s'il n'y en a plus */
+int daemon_take_signal(daemon_server_t *s, int *tab, int *pid, int *signum);
+
+typedef struct daemon_client daemon_client_t;
+
+/* NULL si aucun démon n'écoute sur path */
+daemon_client_t *daemon_connect(const char *path);
+
+/* Flux déjà ouvert (fd, repris) ; child : processus ssh du relais,
+ * arrêté à la déconnexion. Attend l'entête au plus wait_ms. */
+daemon_client_t *daemon_attach(int fd, pid_t child, const char *what, int wait_ms);
+
+void daemon_disconnect(daemon_client_t *c);
+
+const record_tab_t *daemon_client_tabs(const daemon_client_t *c, int *tab_count);
+
+/* Lit les trames disponibles sans bloquer. Retourne 1 et l'onglet mis à
+ * jour (*tab, *ts_ms) pour chaque trame, 0 quand il n'y a plus rien à
+ * lire, -1 si le démon s'est arrêté. */
+int daemon_client_next(daemon_client_t *c, int *tab, long long *ts_ms);
+
+/* Dernier snapshot reçu pour un onglet (copie allouée dans *out) */
+int daemon_client_rows(const daemon_client_t *c, int tab, process_info_t **out, int *count);
+
+void daemon_client_request_refresh(daemon_client_t *c);
+
+/* Le démon envoie le signal au processus de l'onglet tab */
+int daemon_client_send_signal(daemon_client_t *c, int tab, int pid, int signum);
+
+#endif
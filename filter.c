@@ -0,0 +1,556 @@
+#define _POSIX_C_SOURCE 200809L
+#include "filter.h"
+#include "hot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <limits.h>
+
+/* Instructions : l'accumulateur contient le résultat du dernier test */
+enum {
+    OP_TEST = 0,                /* acc = prédicat[arg] */
+    OP_JF,                      /* si !acc, saut à arg (court-circuit de &&) */
+    OP_JT,                      /* si acc, saut à arg (court-circuit de ||) */
+    OP_NOT
+};
+
+typedef enum {
+    T_END = 0,
+    T_AND,
+    T_OR,
+    T_NOT,
+    T_LP,
+    T_RP,
+    T_PRED
+} token_t;
+
+typedef struct {
+    const char *p;
+    filter_t *f;
+    char *err;
+    size_t err_size;
+    int failed;
+    size_t awk_len;
+    int awk_ok;
+} parser_t;
+
+static const struct {
+    const char *name;
+    filter_field_t field;
+} fields[] = {
+    { "pid", FF_PID }, { "user", FF_USER }, { "cpu", FF_CPU }, { "mem", FF_MEM },
+    { "state", FF_STATE }, { "command", FF_COMMAND }, { "cmd", FF_COMMAND },
+    { "rss", FF_RSS }, { "vsz", FF_VSZ }, { "nice", FF_NICE },
+};
+
+static void fail(parser_t *ps, const char *fmt, ...)
+{
+    if (ps->failed) return;
+    ps->failed = 1;
+    if (ps->err && ps->err_size > 0) {
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(ps->err, ps->err_size, fmt, ap);
+        va_end(ap);
+    }
+}
+
+static void awk_put(parser_t *ps, const char *fmt, ...)
+{
+    if (!ps->awk_ok) return;
+    size_t room = sizeof(ps->f->awk) - ps->awk_len;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(ps->f->awk + ps->awk_len, room, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= room) {
+        ps->awk_ok = 0;
+        return;
+    }
+    ps->awk_len += (size_t)n;
+}
+
+/* Valeur recopiable dans le programme awk distant (deux niveaux de shell) */
+static int awk_safe(const char *s)
+{
+    for (; *s; ++s) {
+        if (!isalnum((unsigned char)*s) && strchr("._-@:/+, ", *s) == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int emit(parser_t *ps, unsigned char op, unsigned char arg)
+{
+    if (ps->f->code_len >= FILTER_MAX_CODE) {
+        fail(ps, "expression too long");
+        return 0;
+    }
+    ps->f->code[ps->f->code_len].op = op;
+    ps->f->code[ps->f->code_len].arg = arg;
+    return ps->f->code_len++;
+}
+
+static token_t peek(parser_t *ps)
+{
+    while (isspace((unsigned char)*ps->p)) ps->p++;
+    const char *p = ps->p;
+    if (*p == '\0') return T_END;
+    if (p[0] == '&' && p[1] == '&') return T_AND;
+    if (p[0] == '|' && p[1] == '|') return T_OR;
+    if (p[0] == '!' && p[1] != '=') return T_NOT;
+    if (p[0] == '(') return T_LP;
+    if (p[0] == ')') return T_RP;
+    return T_PRED;
+}
+
+int filter_parse_op(const char **s, unsigned char *op)
+{
+    const char *p = *s;
+    if (p[0] == '<' && p[1] == '=')      { *op = FO_LE; p += 2; }
+    else if (p[0] == '>' && p[1] == '=') { *op = FO_GE; p += 2; }
+    else if (p[0] == '=' && p[1] == '=') { *op = FO_EQ; p += 2; }
+    else if (p[0] == '!' && p[1] == '=') { *op = FO_NE; p += 2; }
+    else if (p[0] == '<')                { *op = FO_LT; p += 1; }
+    else if (p[0] == '>')                { *op = FO_GT; p += 1; }
+    else if (p[0] == '=')                { *op = FO_EQ; p += 1; }
+    else if (p[0] == '~')                { *op = FO_MATCH; p += 1; }
+    else return -1;
+    *s = p;
+    return 0;
+}
+
+static const char *awk_ops[] = { "<", "<=", ">", ">=", "==", "!=" };
+
+/* Traduction awk d'un prédicat ; $1..$5 = pid user pcpu pmem stat, c = comm.
+ * Nombres en %.17g : awk compare exactement la même valeur que le filtre local. */
+static void awk_pred(parser_t *ps, const filter_pred_t *pr)
+{
+    static const char *num_cols[] = { [FF_PID] = "$1", [FF_CPU] = "$3", [FF_MEM] = "$4" };
+
+    switch (pr->field) {
+    case FF_PID:
+    case FF_CPU:
+    case FF_MEM:
+        awk_put(ps, "(%s %s %.17g)", num_cols[pr->field], awk_ops[pr->op], pr->num);
+        return;
+    case FF_USER:
+    case FF_COMMAND: {
+        const char *col = pr->field == FF_USER ? "$2" : "c";
+        if (!awk_safe(pr->str)) break;
+        if (pr->op == FO_MATCH) awk_put(ps, "(index(%s, \"%s\") > 0)", col, pr->str);
+        else                    awk_put(ps, "(%s %s \"%s\")", col, awk_ops[pr->op], pr->str);
+        return;
+    }
+    case FF_STATE:
+        if (!awk_safe(pr->str)) break;
+        if (pr->op == FO_MATCH) awk_put(ps, "(index(\"%s\", substr($5, 1, 1)) > 0)", pr->str);
+        else                    awk_put(ps, "(substr($5, 1, 1) %s \"%.1s\")", awk_ops[pr->op], pr->str);
+        return;
+    default:
+        break;
+    }
+    /* Colonne absente de ps ou valeur non sûre : pas de filtre distant */
+    ps->awk_ok = 0;
+}
+
+static void parse_pred(parser_t *ps)
+{
+    filter_t *f = ps->f;
+    if (f->pred_count >= FILTER_MAX_PREDS) {
+        fail(ps, "too many conditions");
+        return;
+    }
+    filter_pred_t *pr = &f->preds[f->pred_count];
+    memset(pr, 0, sizeof(*pr));
+
+    const char *start = ps->p;
+    while (isalpha((unsigned char)*ps->p)) ps->p++;
+    size_t n = (size_t)(ps->p - start);
+    int field = -1;
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        if (strlen(fields[i].name) == n && strncmp(start, fields[i].name, n) == 0) {
+            field = (int)fields[i].field;
+        }
+    }
+    if (field < 0) {
+        fail(ps, "unknown field \"%.*s\"", (int)(n ? n : 1), start);
+        return;
+    }
+    pr->field = (unsigned char)field;
+
+    while (*ps->p == ' ' || *ps->p == '\t') ps->p++;
+    const char *op = ps->p;
+    if (filter_parse_op(&ps->p, &pr->op) != 0) {
+        fail(ps, "missing operator after \"%.*s\"", (int)n, start);
+        return;
+    }
+    /* Compatibilité avec l'ancien filtre : cmd=TEXT est une sous-chaîne */
+    if (pr->field == FF_COMMAND && op[0] == '=' && op[1] != '=') pr->op = FO_MATCH;
+    while (*ps->p == ' ' || *ps->p == '\t') ps->p++;
+
+    /* Valeur : entre guillemets, ou jusqu'au prochain blanc / opérateur */
+    size_t len = 0;
+    if (*ps->p == '"') {
+        const char *end = strchr(ps->p + 1, '"');
+        if (!end) {
+            fail(ps, "unterminated string");
+            return;
+        }
+        len = (size_t)(end - ps->p - 1);
+        if (len >= sizeof(pr->str)) len = sizeof(pr->str) - 1;
+        memcpy(pr->str, ps->p + 1, len);
+        ps->p = end + 1;
+    } else {
+        const char *v = ps->p;
+        while (*ps->p && !isspace((unsigned char)*ps->p) && strchr("()&|", *ps->p) == NULL) ps->p++;
+        len = (size_t)(ps->p - v);
+        if (len >= sizeof(pr->str)) len = sizeof(pr->str) - 1;
+        memcpy(pr->str, v, len);
+    }
+    pr->str[len] = '\0';
+
+    switch (pr->field) {
+    case FF_USER:
+    case FF_COMMAND:
+        if (pr->op != FO_EQ && pr->op != FO_NE && pr->op != FO_MATCH) {
+            fail(ps, "use ==, != or ~ on text fields");
+        }
+        break;
+    case FF_STATE:
+        if ((pr->op != FO_EQ && pr->op != FO_NE && pr->op != FO_MATCH) || len == 0) {
+            fail(ps, "use state==X, state!=X or state~XYZ");
+        }
+        break;
+    default: {
+        char *end;
+        pr->num = strtod(pr->str, &end);
+        if (pr->op == FO_MATCH || end == pr->str || *end != '\0') {
+            fail(ps, "numeric comparison expected for \"%.*s\"", (int)n, start);
+        }
+        break;
+    }
+    }
+    if (ps->failed) return;
+
+    awk_pred(ps, pr);
+    emit(ps, OP_TEST, (unsigned char)f->pred_count++);
+}
+
+static void parse_or(parser_t *ps);
+
+static void parse_unary(parser_t *ps)
+{
+    switch (peek(ps)) {
+    case T_NOT:
+        ps->p++;
+        awk_put(ps, "!");
+        parse_unary(ps);
+        emit(ps, OP_NOT, 0);
+        break;
+    case T_LP:
+        ps->p++;
+        awk_put(ps, "(");
+        parse_or(ps);
+        if (peek(ps) != T_RP) {
+            fail(ps, "missing \")\"");
+            return;
+        }
+        ps->p++;
+        awk_put(ps, ")");
+        break;
+    case T_PRED:
+        parse_pred(ps);
+        break;
+    default:
+        fail(ps, "condition expected near \"%.16s\"", ps->p);
+        break;
+    }
+}
+
+/* Les sauts d'une chaîne &&/|| pointent après son dernier terme */
+static void parse_chain(parser_t *ps, token_t sep, unsigned char jump, const char *awk_sep,
+                        void (*term)(parser_t *))
+{
+    int jumps[FILTER_MAX_CODE];
+    int nj = 0;
+
+    term(ps);
+    while (!ps->failed) {
+        token_t t = peek(ps);
+        if (t == sep) {
+            ps->p += 2;
+        } else if (!(sep == T_AND && (t == T_PRED || t == T_NOT || t == T_LP))) {
+            break;      /* juxtaposition = && */
+        }
+        awk_put(ps, "%s", awk_sep);
+        jumps[nj++] = emit(ps, jump, 0);
+        term(ps);
+    }
+    for (int i = 0; i < nj && !ps->failed; ++i) {
+        ps->f->code[jumps[i]].arg = (unsigned char)ps->f->code_len;
+    }
+}
+
+static void parse_and(parser_t *ps)
+{
+    parse_chain(ps, T_AND, OP_JF, " && ", parse_unary);
+}
+
+static void parse_or(parser_t *ps)
+{
+    parse_chain(ps, T_OR, OP_JT, " || ", parse_and);
+}
+
+int filter_compile(const char *text, filter_t *f, char *err, size_t err_size)
+{
+    memset(f, 0, sizeof(*f));
+    if (err && err_size > 0) err[0] = '\0';
+    if (!text) return 0;
+
+    parser_t ps = { text, f, err, err_size, 0, 0, 1 };
+    if (peek(&ps) == T_END) return 0;
+
+    parse_or(&ps);
+    if (!ps.failed && peek(&ps) != T_END) {
+        fail(&ps, "unexpected \"%.16s\"", ps.p);
+    }
+    if (ps.failed) {
+        memset(f, 0, sizeof(*f));
+        return -1;
+    }
+    if (!ps.awk_ok) f->awk[0] = '\0';
+    return 0;
+}
+
+int filter_cmp_num(double v, unsigned char op, double ref)
+{
+    switch (op) {
+    case FO_LT: return v < ref;
+    case FO_LE: return v <= ref;
+    case FO_GT: return v > ref;
+    case FO_GE: return v >= ref;
+    case FO_EQ: return v == ref;
+    case FO_NE: return v != ref;
+    default:    return 0;
+    }
+}
+
+static int cmp_str(const char *v, unsigned char op, const char *ref)
+{
+    switch (op) {
+    case FO_EQ:    return strcmp(v, ref) == 0;
+    case FO_NE:    return strcmp(v, ref) != 0;
+    case FO_MATCH: return strstr(v, ref) != NULL;
+    default:       return 0;
+    }
+}
+
+static int pred_match(const filter_pred_t *pr, const process_info_t *p)
+{
+    int stat_ok = (p->filled & PROC_NEED_STAT) != 0;
+
+    switch (pr->field) {
+    case FF_PID:     return filter_cmp_num((double)p->pid, pr->op, pr->num);
+    case FF_CPU:     return filter_cmp_num(p->cpu_usage, pr->op, pr->num);
+    case FF_MEM:     return filter_cmp_num(p->mem_usage, pr->op, pr->num);
+    case FF_RSS:     return filter_cmp_num(stat_ok ? (double)p->rss_kb : 0.0, pr->op, pr->num);
+    case FF_VSZ:     return filter_cmp_num(stat_ok ? (double)p->vsz_kb : 0.0, pr->op, pr->num);
+    case FF_NICE:    return filter_cmp_num(stat_ok ? (double)p->nice : 0.0, pr->op, pr->num);
+    case FF_USER:    return cmp_str(p->user, pr->op, pr->str);
+    case FF_COMMAND: return cmp_str(p->command, pr->op, pr->str);
+    case FF_STATE:
+        if (pr->op == FO_MATCH) return p->state != '\0' && strchr(pr->str, p->state) != NULL;
+        return (p->state == pr->str[0]) == (pr->op == FO_EQ);
+    default:
+        return 0;
+    }
+}
+
+int filter_match(const filter_t *f, const process_info_t *p)
+{
+    int acc = 1;
+    int pc = 0;
+    while (pc < f->code_len) {
+        const filter_insn_t *in = &f->code[pc];
+        switch (in->op) {
+        case OP_TEST: acc = pred_match(&f->preds[in->arg], p); pc++; break;
+        case OP_JF:   pc = acc ? pc + 1 : in->arg; break;
+        case OP_JT:   pc = acc ? in->arg : pc + 1; break;
+        default:      acc = !acc; pc++; break;
+        }
+    }
+    return acc;
+}
+
+/* --- Requête : expression + tri + limite --- */
+
+int process_query_parse(const char *text, process_query_t *q, char *err, size_t err_size)
+{
+    if (err && err_size > 0) err[0] = '\0';
+    memset(q, 0, sizeof(*q));
+    if (!text) return 0;
+
+    char buf[256];
+    if (strlen(text) >= sizeof(buf)) {
+        if (err && err_size > 0) snprintf(err, err_size, "filter too long");
+        return -1;
+    }
+    strcpy(buf, text);
+
+    /* sort= et top= sont extraits, le reste forme l'expression */
+    size_t off = 0;
+    char *p = buf;
+    while (*p) {
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') break;
+        char *tok = p;
+        int quoted = 0;
+        while (*p && (quoted || !isspace((unsigned char)*p))) {
+            if (*p == '"') quoted = !quoted;
+            p++;
+        }
+        if (*p) *p++ = '\0';
+
+        if (strncmp(tok, "sort=", 5) == 0) {
+            if (strcmp(tok + 5, "cpu") == 0)      q->sort = PROC_SORT_CPU;
+            else if (strcmp(tok + 5, "mem") == 0) q->sort = PROC_SORT_MEM;
+            else if (strcmp(tok + 5, "pss") == 0) q->sort = PROC_SORT_PSS;
+            else {
+                if (err && err_size > 0) snprintf(err, err_size, "sort=cpu, mem or pss");
+                return -1;
+            }
+        } else if (strncmp(tok, "top=", 4) == 0) {
+            char *end;
+            errno = 0;
+            long n = strtol(tok + 4, &end, 10);
+            if (end == tok + 4 || *end != '\0' || errno != 0 || n < 0 || n > INT_MAX) {
+                if (err && err_size > 0) snprintf(err, err_size, "top=N expects N >= 0");
+                return -1;
+            }
+            q->limit = (int)n;
+        } else {
+            /* Un jeton coupé changerait le sens de l'expression */
+            int w = snprintf(q->text + off, sizeof(q->text) - off, "%s%s", off ? " " : "", tok);
+            if (w < 0 || (size_t)w >= sizeof(q->text) - off) {
+                if (err && err_size > 0) snprintf(err, err_size, "filter too long");
+                return -1;
+            }
+            off += (size_t)w;
+        }
+    }
+    /* top=N sans tri explicite : les plus gros consommateurs CPU */
+    if (q->limit > 0 && q->sort == PROC_SORT_NONE) q->sort = PROC_SORT_CPU;
+
+    return filter_compile(q->text, &q->filter, err, err_size);
+}
+
+void process_query_format(const process_query_t *q, char *buf, size_t size)
+{
+    size_t off = 0;
+    buf[0] = '\0';
+
+    if (q->text[0] != '\0' && off < size)
+        off += (size_t)snprintf(buf + off, size - off, "%s ", q->text);
+    if (q->sort != PROC_SORT_NONE && off < size)
+        off += (size_t)snprintf(buf + off, size - off, "sort=%s ",
+                                q->sort == PROC_SORT_MEM ? "mem" :
+                                q->sort == PROC_SORT_PSS ? "pss" : "cpu");
+    if (q->limit > 0 && off < size)
+        off += (size_t)snprintf(buf + off, size - off, "top=%d ", q->limit);
+
+    if (off > 0 && off <= size) buf[off - 1] = '\0';
+}
+
+int process_query_active(const process_query_t *q)
+{
+    return q && (q->filter.code_len > 0 || q->sort != PROC_SORT_NONE || q->limit > 0);
+}
+
+int process_query_match(const process_query_t *q, const process_info_t *p)
+{
+    return !q || filter_match(&q->filter, p);
+}
+
+/* Filtre réduit à un seuil sur %CPU ou %MEM : index du prédicat, -1 sinon */
+static int simple_threshold(const filter_t *f)
+{
+    if (f->code_len != 1 || f->code[0].op != OP_TEST) return -1;
+    const filter_pred_t *pr = &f->preds[f->code[0].arg];
+    if ((pr->field != FF_CPU && pr->field != FF_MEM) || pr->op == FO_MATCH) return -1;
+    return f->code[0].arg;
+}
+
+/* Filtre, tri et top-N travaillent sur les colonnes chaudes et des
+ * indices ; les lignes retenues ne sont copiées qu'une fois, dans l'ordre
+ * final. */
+int process_array_apply_query(process_info_t *arr, int count, const process_query_t *q)
+{
+    if (!arr || count <= 0 || !process_query_active(q)) return count;
+
+    hot_columns_t h = {0};
+    int *idx = malloc((size_t)count * 2 * sizeof(int));
+    if (!idx || hot_columns_build(&h, arr, count) != 0) {
+        perror("malloc query");
+        free(idx);
+        return count;
+    }
+    int *order = idx + count;
+
+    int n = 0;
+    int pred = simple_threshold(&q->filter);
+    if (pred >= 0) {
+        const filter_pred_t *pr = &q->filter.preds[pred];
+        n = hot_select(pr->field == FF_CPU ? h.cpu : h.mem, count, pr->op, pr->num, idx);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            if (filter_match(&q->filter, &arr[i])) idx[n++] = i;
+        }
+    }
+
+    int r = n;
+    int permuted = 0;
+    if (q->sort != PROC_SORT_NONE && n > 1) {
+        /* Clés des lignes retenues, tassées en tête de colonne. PSS : la
+         * colonne %MEM sert de tampon ; les lignes pas encore lues sont
+         * classées en dernier. */
+        double *key = (q->sort == PROC_SORT_CPU) ? h.cpu : h.mem;
+        for (int j = 0; j < n; ++j) {
+            if (q->sort == PROC_SORT_PSS) {
+                const process_info_t *p = &arr[idx[j]];
+                key[j] = (p->filled & PROC_NEED_SMAPS) ? (double)p->pss_kb : -1.0;
+            } else {
+                key[j] = key[idx[j]];
+            }
+            h.pid[j] = h.pid[idx[j]];
+        }
+        if (q->limit > 0 && q->limit < n) r = hot_topk(key, h.pid, n, q->limit, order);
+        else                              r = hot_sort_desc(key, h.pid, n, order);
+
+        process_info_t *sorted = r > 0 ? malloc((size_t)r * sizeof(process_info_t)) : NULL;
+        if (sorted) {
+            for (int j = 0; j < r; ++j) sorted[j] = arr[idx[order[j]]];
+            memcpy(arr, sorted, (size_t)r * sizeof(process_info_t));
+            free(sorted);
+            permuted = 1;
+        } else {
+            /* Mémoire insuffisante : filtré, non trié */
+            r = n;
+        }
+    }
+    if (!permuted) {
+        for (int j = 0; j < r; ++j) {
+            if (idx[j] != j) arr[j] = arr[idx[j]];
+        }
+    }
+
+    if (q->limit > 0 && r > q->limit) r = q->limit;
+    free(idx);
+    hot_columns_free(&h);
+    return r;
+}
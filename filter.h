@@ -0,0 +1,112 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stddef.h>
+#include "process.h"
+
+/*
+ * Expressions de filtre sur les colonnes :
+ *
+ *   user==postgres && cpu>5 || state==D
+ *   command~java !(user==root) mem>=1.5
+ *
+ * Champs : pid user cpu mem state command (cmd) rss vsz nice
+ * Opérateurs : < <= > >= == != ~ (sous-chaîne ; pour state, un des
+ * caractères). "=" vaut "==", sauf "cmd=TEXT" qui reste une sous-chaîne.
+ * && est prioritaire sur || ; deux termes juxtaposés valent &&.
+ *
+ * L'expression est compilée en un petit programme à accumulateur (tests
+ * et sauts courts-circuits) évalué sans allocation pour chaque ligne.
+ */
+
+#define FILTER_MAX_PREDS 16
+#define FILTER_MAX_CODE  48
+#define FILTER_AWK_LEN   512
+
+typedef enum {
+    FF_PID = 0,
+    FF_USER,
+    FF_CPU,
+    FF_MEM,
+    FF_STATE,
+    FF_COMMAND,
+    FF_RSS,
+    FF_VSZ,
+    FF_NICE
+} filter_field_t;
+
+typedef enum {
+    FO_LT = 0,
+    FO_LE,
+    FO_GT,
+    FO_GE,
+    FO_EQ,
+    FO_NE,
+    FO_MATCH
+} filter_op_t;
+
+typedef struct {
+    unsigned char field;
+    unsigned char op;
+    double num;
+    char str[64];
+} filter_pred_t;
+
+typedef struct {
+    unsigned char op;
+    unsigned char arg;          /* prédicat testé ou cible du saut */
+} filter_insn_t;
+
+typedef struct {
+    filter_insn_t code[FILTER_MAX_CODE];
+    int code_len;               /* 0 = tout accepter */
+    filter_pred_t preds[FILTER_MAX_PREDS];
+    int pred_count;
+
+    /* Même expression en awk sur la sortie de "ps -eo pid,user,pcpu,pmem,stat,comm",
+     * "" si elle n'est pas traduisible (champ absent de ps, valeur non sûre) */
+    char awk[FILTER_AWK_LEN];
+} filter_t;
+
+/* Retourne -1 et décrit l'erreur dans err si l'expression est invalide */
+int filter_compile(const char *text, filter_t *f, char *err, size_t err_size);
+
+int filter_match(const filter_t *f, const process_info_t *p);
+
+/* Utilisés aussi par les règles de surveillance */
+int filter_parse_op(const char **s, unsigned char *op);
+int filter_cmp_num(double v, unsigned char op, double ref);
+
+/* Clé de tri / de classement des processus */
+typedef enum {
+    PROC_SORT_NONE = 0,
+    PROC_SORT_CPU,
+    PROC_SORT_MEM,
+    PROC_SORT_PSS               /* local, valeurs du cache smaps (smaps.h) */
+} process_sort_t;
+
+/* Filtre / tri / limite appliqués à la collecte. Côté distant ils sont
+ * traduits en arguments de ps et en awk pour ne transférer que les lignes
+ * utiles. */
+typedef struct {
+    char text[128];             /* expression, "" = tous les processus */
+    filter_t filter;
+    process_sort_t sort;
+    int limit;                  /* 0 = pas de limite */
+} process_query_t;
+
+/* Syntaxe : "EXPRESSION sort=cpu|mem|pss top=N" (parties optionnelles).
+ * Retourne -1 si invalide, avec l'erreur dans err (peut être NULL). */
+int process_query_parse(const char *text, process_query_t *q, char *err, size_t err_size);
+
+void process_query_format(const process_query_t *q, char *buf, size_t size);
+
+int process_query_active(const process_query_t *q);
+
+int process_query_match(const process_query_t *q, const process_info_t *p);
+
+/* Filtre, trie et tronque un tableau de processus en place.
+ * Retourne le nouveau nombre d'éléments. */
+int process_array_apply_query(process_info_t *arr, int count, const process_query_t *q);
+
+#endif
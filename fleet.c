@@ -0,0 +1,161 @@
+#include "fleet.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static double key_value(const process_info_t *p, process_sort_t key)
+{
+    return (key == PROC_SORT_MEM) ? p->mem_usage : p->cpu_usage;
+}
+
+/* a passe avant b ? (valeur décroissante, puis pid croissant) */
+static int ranks_before(const process_info_t *a, const process_info_t *b, process_sort_t key)
+{
+    double va = key_value(a, key);
+    double vb = key_value(b, key);
+    if (va != vb) return va > vb;
+    return a->pid < b->pid;
+}
+
+int fleet_rank_tab(machine_tab_t *tab, int k)
+{
+    if (!tab || k <= 0) return -1;
+
+    int n = tab->process_count < k ? tab->process_count : k;
+    int *cpu = realloc(tab->rank_cpu, (size_t)(n > 0 ? n : 1) * sizeof(int));
+    if (!cpu) {
+        perror("realloc rank_cpu");
+        return -1;
+    }
+    tab->rank_cpu = cpu;
+
+    int *mem = realloc(tab->rank_mem, (size_t)(n > 0 ? n : 1) * sizeof(int));
+    if (!mem) {
+        perror("realloc rank_mem");
+        return -1;
+    }
+    tab->rank_mem = mem;
+
+    /* Sélection sur les colonnes chaudes, normalement à jour (ui_tab_updated) */
+    const hot_columns_t *h = &tab->hot;
+    if (h->count != tab->process_count &&
+        hot_columns_build(&tab->hot, tab->processes, tab->process_count) != 0) {
+        return -1;
+    }
+    hot_topk(h->cpu, h->pid, h->count, k, tab->rank_cpu);
+    tab->rank_count = hot_topk(h->mem, h->pid, h->count, k, tab->rank_mem);
+    return 0;
+}
+
+/* Tête de run d'un onglet pendant la fusion */
+typedef struct {
+    int tab;
+    int pos;
+} run_head_t;
+
+static const process_info_t *head_proc(const ui_context_t *ctx, const run_head_t *h)
+{
+    const machine_tab_t *t = &ctx->tabs[h->tab];
+    const int *run = (ctx->fleet_key == PROC_SORT_MEM) ? t->rank_mem : t->rank_cpu;
+    return &t->processes[run[h->pos]];
+}
+
+static void heads_sift_down(const ui_context_t *ctx, run_head_t *heap, int n, int i)
+{
+    for (;;) {
+        int l = 2 * i + 1;
+        int r = l + 1;
+        int best = i;
+        if (l < n && ranks_before(head_proc(ctx, &heap[l]), head_proc(ctx, &heap[best]), ctx->fleet_key)) best = l;
+        if (r < n && ranks_before(head_proc(ctx, &heap[r]), head_proc(ctx, &heap[best]), ctx->fleet_key)) best = r;
+        if (best == i) return;
+        run_head_t t = heap[i];
+        heap[i] = heap[best];
+        heap[best] = t;
+        i = best;
+    }
+}
+
+int fleet_merge(ui_context_t *ctx)
+{
+    if (!ctx || ctx->fleet_tab_index < 0 || ctx->fleet_tab_index >= ctx->tab_count) {
+        return -1;
+    }
+
+    machine_tab_t *fleet = &ctx->tabs[ctx->fleet_tab_index];
+    int k = ctx->fleet_k > 0 ? ctx->fleet_k : FLEET_DEFAULT_K;
+
+    /* Sélection à conserver : (onglet d'origine, pid) */
+    int sel_origin = -1, sel_pid = -1;
+    if (fleet->origin && fleet->selected_proc_index >= 0 &&
+        fleet->selected_proc_index < fleet->process_count) {
+        sel_origin = fleet->origin[fleet->selected_proc_index];
+        sel_pid = fleet->processes[fleet->selected_proc_index].pid;
+    }
+
+    run_head_t *heap = malloc((size_t)ctx->tab_count * sizeof(run_head_t));
+    process_info_t *rows = malloc((size_t)k * sizeof(process_info_t));
+    int *origin = malloc((size_t)k * sizeof(int));
+    if (!heap || !rows || !origin) {
+        perror("malloc fleet merge");
+        free(heap);
+        free(rows);
+        free(origin);
+        return -1;
+    }
+
+    int n = 0;
+    for (int t = 0; t < ctx->tab_count; ++t) {
+        if (t == ctx->fleet_tab_index || ctx->tabs[t].rank_count == 0) continue;
+        heap[n].tab = t;
+        heap[n].pos = 0;
+        n++;
+    }
+    for (int i = n / 2 - 1; i >= 0; --i) {
+        heads_sift_down(ctx, heap, n, i);
+    }
+
+    int count = 0;
+    while (n > 0 && count < k) {
+        rows[count] = *head_proc(ctx, &heap[0]);
+        origin[count] = heap[0].tab;
+        count++;
+
+        heap[0].pos++;
+        if (heap[0].pos >= ctx->tabs[heap[0].tab].rank_count) {
+            heap[0] = heap[--n];
+        }
+        heads_sift_down(ctx, heap, n, 0);
+    }
+    free(heap);
+
+    free(fleet->processes);
+    free(fleet->origin);
+    fleet->processes = rows;
+    fleet->origin = origin;
+    fleet->process_count = count;
+
+    fleet->selected_proc_index = 0;
+    for (int i = 0; i < count; ++i) {
+        if (origin[i] == sel_origin && rows[i].pid == sel_pid) {
+            fleet->selected_proc_index = i;
+            break;
+        }
+    }
+
+    ui_tab_updated(fleet);
+    return 0;
+}
+
+void fleet_free_tab(machine_tab_t *tab)
+{
+    if (!tab) return;
+    free(tab->rank_cpu);
+    free(tab->rank_mem);
+    free(tab->origin);
+    tab->rank_cpu = NULL;
+    tab->rank_mem = NULL;
+    tab->origin = NULL;
+    tab->rank_count = 0;
+}
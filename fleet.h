@@ -0,0 +1,18 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include "ui.h"
+
+#define FLEET_DEFAULT_K 100
+
+/* Recalcule le top-K (par %CPU et par %MEM) d'un onglet à partir des
+ * colonnes chaudes de son snapshot, via un tas borné de taille k. */
+int fleet_rank_tab(machine_tab_t *tab, int k);
+
+/* Fusion k-voies des top-K de chaque onglet dans l'onglet "All hosts".
+ * Seuls les runs déjà triés sont lus : O(k log H) pour H onglets. */
+int fleet_merge(ui_context_t *ctx);
+
+void fleet_free_tab(machine_tab_t *tab);
+
+#endif
@@ -0,0 +1,359 @@
+#include "group.h"
+#include "cgroup.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static unsigned long hash_str(const char *s)
+{
+    /* FNV-1a */
+    unsigned long h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static unsigned long hash_pid(int pid)
+{
+    return (unsigned long)(unsigned int)pid * 2654435761u;
+}
+
+static const char *key_of(const group_table_t *gt, const process_info_t *p)
+{
+    if (gt->mode == GROUP_BY_CGROUP) {
+        const cgroup_info_t *cg = cgroup_get(p->cgroup_id);
+        return cg ? cg->path : "-";
+    }
+    return (gt->mode == GROUP_BY_USER) ? p->user : p->command;
+}
+
+group_table_t *group_table_create(group_mode_t mode)
+{
+    group_table_t *gt = calloc(1, sizeof(group_table_t));
+    if (!gt) {
+        perror("calloc group_table");
+        return NULL;
+    }
+    gt->mode = mode;
+    gt->sort = GROUP_SORT_CPU;
+    return gt;
+}
+
+void group_table_free(group_table_t *gt)
+{
+    if (!gt) return;
+    free(gt->groups);
+    free(gt->key_slots);
+    free(gt->members);
+    free(gt->group_of);
+    free(gt->lines);
+    free(gt);
+}
+
+static void group_table_reset(group_table_t *gt)
+{
+    free(gt->members);
+    gt->members = NULL;
+    gt->member_cap = 0;
+
+    gt->group_count = 0;
+    gt->live_groups = 0;
+    for (size_t i = 0; i < gt->key_slot_cap; ++i) {
+        gt->key_slots[i] = -1;
+    }
+}
+
+static int rehash_keys(group_table_t *gt, size_t newcap)
+{
+    int *slots = malloc(newcap * sizeof(int));
+    if (!slots) return -1;
+    for (size_t i = 0; i < newcap; ++i) slots[i] = -1;
+
+    for (int g = 0; g < gt->group_count; ++g) {
+        size_t h = hash_str(gt->groups[g].key) & (newcap - 1);
+        while (slots[h] != -1) h = (h + 1) & (newcap - 1);
+        slots[h] = g;
+    }
+
+    free(gt->key_slots);
+    gt->key_slots = slots;
+    gt->key_slot_cap = newcap;
+    return 0;
+}
+
+static int find_or_add_group(group_table_t *gt, const char *key)
+{
+    if ((size_t)(gt->group_count + 1) * 2 > gt->key_slot_cap) {
+        size_t newcap = gt->key_slot_cap ? gt->key_slot_cap * 2 : 64;
+        if (rehash_keys(gt, newcap) != 0) return -1;
+    }
+
+    size_t mask = gt->key_slot_cap - 1;
+    size_t h = hash_str(key) & mask;
+    while (gt->key_slots[h] != -1) {
+        int g = gt->key_slots[h];
+        if (strcmp(gt->groups[g].key, key) == 0) return g;
+        h = (h + 1) & mask;
+    }
+
+    if (gt->group_count >= gt->group_cap) {
+        int newcap = gt->group_cap ? gt->group_cap * 2 : 32;
+        process_group_t *tmp = realloc(gt->groups, (size_t)newcap * sizeof(process_group_t));
+        if (!tmp) return -1;
+        gt->groups = tmp;
+        gt->group_cap = newcap;
+    }
+
+    int g = gt->group_count++;
+    process_group_t *grp = &gt->groups[g];
+    memset(grp, 0, sizeof(*grp));
+    strncpy(grp->key, key, sizeof(grp->key) - 1);
+    gt->key_slots[h] = g;
+    return g;
+}
+
+static group_member_t *member_find(group_member_t *tab, size_t cap, int pid)
+{
+    if (!tab || cap == 0) return NULL;
+    size_t mask = cap - 1;
+    size_t h = hash_pid(pid) & mask;
+    while (tab[h].pid != 0) {
+        if (tab[h].pid == pid) return &tab[h];
+        h = (h + 1) & mask;
+    }
+    return NULL;
+}
+
+static void member_insert(group_member_t *tab, size_t cap, const group_member_t *m)
+{
+    size_t mask = cap - 1;
+    size_t h = hash_pid(m->pid) & mask;
+    while (tab[h].pid != 0) h = (h + 1) & mask;
+    tab[h] = *m;
+}
+
+static void group_add(group_table_t *gt, int g, double cpu, double mem)
+{
+    process_group_t *grp = &gt->groups[g];
+    if (grp->count == 0) gt->live_groups++;
+    grp->count++;
+    grp->cpu_total += cpu;
+    grp->mem_total += mem;
+}
+
+static void group_remove(group_table_t *gt, const group_member_t *m)
+{
+    process_group_t *grp = &gt->groups[m->group];
+    grp->count--;
+    grp->cpu_total -= m->cpu;
+    grp->mem_total -= m->mem;
+    if (grp->count <= 0) {
+        /* Remise à zéro pour ne pas accumuler d'erreur d'arrondi */
+        grp->count = 0;
+        grp->cpu_total = 0.0;
+        grp->mem_total = 0.0;
+        gt->live_groups--;
+    }
+}
+
+int group_table_update(group_table_t *gt, const process_info_t *procs, int count)
+{
+    if (!gt || gt->mode == GROUP_NONE) return -1;
+    if (count < 0) count = 0;
+
+    /* Trop de groupes morts : on repart de zéro */
+    if (gt->group_count > 2 * gt->live_groups + 64) {
+        group_table_reset(gt);
+    }
+
+    size_t cap = 16;
+    while (cap < (size_t)count * 2) cap <<= 1;
+    group_member_t *next = calloc(cap, sizeof(group_member_t));
+    if (!next) {
+        perror("calloc group members");
+        return -1;
+    }
+
+    if (count > gt->group_of_cap) {
+        int *tmp = realloc(gt->group_of, (size_t)count * sizeof(int));
+        if (!tmp) {
+            perror("realloc group_of");
+            free(next);
+            return -1;
+        }
+        gt->group_of = tmp;
+        gt->group_of_cap = count;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const process_info_t *p = &procs[i];
+        const char *key = key_of(gt, p);
+        group_member_t *old = member_find(gt->members, gt->member_cap, p->pid);
+        int g;
+
+        if (old && !old->seen && strcmp(gt->groups[old->group].key, key) == 0) {
+            /* Même PID, même groupe : on applique seulement le delta */
+            g = old->group;
+            gt->groups[g].cpu_total += p->cpu_usage - old->cpu;
+            gt->groups[g].mem_total += p->mem_usage - old->mem;
+            old->seen = 1;
+        } else {
+            if (old && !old->seen) {
+                group_remove(gt, old);
+                old->seen = 1;
+            }
+            g = find_or_add_group(gt, key);
+            if (g < 0) {
+                perror("group table");
+                free(next);
+                group_table_reset(gt);
+                return -1;
+            }
+            group_add(gt, g, p->cpu_usage, p->mem_usage);
+            gt->groups[g].cgroup_id = p->cgroup_id;
+        }
+
+        group_member_t m = { p->pid, g, p->cpu_usage, p->mem_usage, 0 };
+        if (p->pid != 0) {
+            member_insert(next, cap, &m);
+        }
+        gt->group_of[i] = g;
+    }
+
+    /* PIDs disparus depuis le dernier snapshot */
+    for (size_t i = 0; i < gt->member_cap; ++i) {
+        if (gt->members[i].pid != 0 && !gt->members[i].seen) {
+            group_remove(gt, &gt->members[i]);
+        }
+    }
+
+    free(gt->members);
+    gt->members = next;
+    gt->member_cap = cap;
+
+    return group_table_build_lines(gt, count);
+}
+
+static const group_table_t *sort_ctx;
+
+static int compare_groups(const void *a, const void *b)
+{
+    const process_group_t *ga = &sort_ctx->groups[*(const int *)a];
+    const process_group_t *gb = &sort_ctx->groups[*(const int *)b];
+    double va, vb;
+
+    switch (sort_ctx->sort) {
+    case GROUP_SORT_MEM:
+        va = ga->mem_total;
+        vb = gb->mem_total;
+        break;
+    case GROUP_SORT_COUNT:
+        va = ga->count;
+        vb = gb->count;
+        break;
+    case GROUP_SORT_CPU:
+    default:
+        va = ga->cpu_total;
+        vb = gb->cpu_total;
+        break;
+    }
+
+    if (va < vb) return 1;
+    if (va > vb) return -1;
+    return strcmp(ga->key, gb->key);
+}
+
+int group_table_build_lines(group_table_t *gt, int count)
+{
+    if (!gt) return -1;
+
+    int prev_group = -1;
+    if (gt->selected_line >= 0 && gt->selected_line < gt->line_count) {
+        prev_group = gt->lines[gt->selected_line].group;
+    }
+
+    int *order = malloc((size_t)(gt->live_groups > 0 ? gt->live_groups : 1) * sizeof(int));
+    if (!order) {
+        perror("malloc group order");
+        return -1;
+    }
+    int n = 0;
+    int members_shown = 0;
+    for (int g = 0; g < gt->group_count && n < gt->live_groups; ++g) {
+        if (gt->groups[g].count > 0) {
+            order[n++] = g;
+            if (gt->groups[g].expanded) members_shown += gt->groups[g].count;
+        }
+    }
+
+    sort_ctx = gt;
+    qsort(order, (size_t)n, sizeof(int), compare_groups);
+    sort_ctx = NULL;
+
+    int needed = n + members_shown;
+    if (needed > gt->line_cap) {
+        group_line_t *tmp = realloc(gt->lines, (size_t)needed * sizeof(group_line_t));
+        if (!tmp) {
+            perror("realloc group lines");
+            free(order);
+            return -1;
+        }
+        gt->lines = tmp;
+        gt->line_cap = needed;
+    }
+
+    int l = 0;
+    int selected = 0;
+    for (int k = 0; k < n; ++k) {
+        int g = order[k];
+        if (g == prev_group) selected = l;
+        gt->lines[l].group = g;
+        gt->lines[l].proc = -1;
+        l++;
+
+        if (!gt->groups[g].expanded) continue;
+        for (int i = 0; i < count && l < needed; ++i) {
+            if (gt->group_of[i] == g) {
+                gt->lines[l].group = g;
+                gt->lines[l].proc = i;
+                l++;
+            }
+        }
+    }
+
+    gt->line_count = l;
+    gt->selected_line = selected;
+    free(order);
+    return 0;
+}
+
+void group_table_toggle_expand(group_table_t *gt)
+{
+    if (!gt || gt->selected_line < 0 || gt->selected_line >= gt->line_count) {
+        return;
+    }
+    int g = gt->lines[gt->selected_line].group;
+    gt->groups[g].expanded = !gt->groups[g].expanded;
+}
+
+const char *group_mode_name(group_mode_t mode)
+{
+    switch (mode) {
+    case GROUP_BY_USER:    return "user";
+    case GROUP_BY_COMMAND: return "command";
+    case GROUP_BY_CGROUP:  return "cgroup";
+    default:               return "none";
+    }
+}
+
+const char *group_sort_name(group_sort_t sort)
+{
+    switch (sort) {
+    case GROUP_SORT_MEM:   return "%MEM";
+    case GROUP_SORT_COUNT: return "count";
+    default:               return "%CPU";
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include "process.h"
+#include "cgroup.h"
+
+typedef enum {
+    GROUP_NONE = 0,
+    GROUP_BY_USER,
+    GROUP_BY_COMMAND,
+    GROUP_BY_CGROUP,
+    GROUP_MODE_COUNT
+} group_mode_t;
+
+typedef enum {
+    GROUP_SORT_CPU = 0,
+    GROUP_SORT_MEM,
+    GROUP_SORT_COUNT,
+    GROUP_SORT_KEY_COUNT
+} group_sort_t;
+
+typedef struct {
+    char key[CGROUP_PATH_MAX];  /* utilisateur, commande ou chemin de cgroup */
+    int count;
+    double cpu_total;
+    double mem_total;
+    int expanded;
+    int cgroup_id;          /* GROUP_BY_CGROUP : stats du cgroup lui-même */
+} process_group_t;
+
+/* Contribution d'un PID au snapshot précédent (table ouverte indexée par pid) */
+typedef struct {
+    int pid;            /* 0 = case vide */
+    int group;
+    double cpu;
+    double mem;
+    int seen;
+} group_member_t;
+
+/* Ligne affichée : entête de groupe (proc == -1) ou processus membre */
+typedef struct {
+    int group;
+    int proc;
+} group_line_t;
+
+typedef struct {
+    group_mode_t mode;
+    group_sort_t sort;
+
+    process_group_t *groups;
+    int group_count;
+    int group_cap;
+    int live_groups;
+
+    int *key_slots;         /* hash clé -> index de groupe, -1 = vide */
+    size_t key_slot_cap;
+
+    group_member_t *members;
+    size_t member_cap;
+
+    int *group_of;          /* groupe de chaque ligne du snapshot courant */
+    int group_of_cap;
+
+    group_line_t *lines;
+    int line_count;
+    int line_cap;
+    int selected_line;
+} group_table_t;
+
+group_table_t *group_table_create(group_mode_t mode);
+void group_table_free(group_table_t *gt);
+
+/* Applique un nouveau snapshot : les totaux sont corrigés par les deltas
+ * de chaque PID par rapport au snapshot précédent. */
+int group_table_update(group_table_t *gt, const process_info_t *procs, int count);
+
+/* Reconstruit la liste des lignes affichées (tri + groupes dépliés). */
+int group_table_build_lines(group_table_t *gt, int count);
+
+void group_table_toggle_expand(group_table_t *gt);
+
+const char *group_mode_name(group_mode_t mode);
+const char *group_sort_name(group_sort_t sort);
+
+#endif
@@ -0,0 +1,222 @@
+#define _POSIX_C_SOURCE 200809L
+#include "hoststat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+void host_sample_init(host_sample_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < 3; ++i) s->load[i] = -1.0;
+    for (int i = 0; i < HOST_PSI_COUNT; ++i) s->psi[i] = -1.0;
+    s->tasks = -1;
+}
+
+/* "cpu  user nice system idle iowait irq softirq steal guest guest_nice" */
+static void parse_cpu_line(host_sample_t *s, const char *line)
+{
+    int slot = 0;
+    const char *p = line + 3;
+    if (*p >= '0' && *p <= '9') {
+        int n = (int)strtol(p, (char **)&p, 10);
+        if (n >= HOST_MAX_CPUS) return;
+        slot = n + 1;
+        if (n + 1 > s->cpu_count) s->cpu_count = n + 1;
+    }
+
+    unsigned long long v[8] = {0};
+    for (int i = 0; i < 8; ++i) {
+        char *end;
+        v[i] = strtoull(p, &end, 10);
+        if (end == p) break;
+        p = end;
+    }
+    /* guest est déjà compté dans user */
+    unsigned long long total = 0;
+    for (int i = 0; i < 8; ++i) total += v[i];
+    s->total[slot] = total;
+    s->busy[slot] = total - v[3] - v[4];
+}
+
+static void parse_psi_line(host_sample_t *s, int which, const char *line)
+{
+    const char *p = strstr(line, "some avg10=");
+    if (p) s->psi[which] = strtod(p + 11, NULL);
+}
+
+static void parse_line(host_sample_t *s, const char *line)
+{
+    unsigned long long kb;
+
+    if (strncmp(line, "cpu", 3) == 0) {
+        parse_cpu_line(s, line);
+    } else if (sscanf(line, "MemTotal: %llu", &kb) == 1) {
+        s->mem_total_kb = kb;
+    } else if (sscanf(line, "MemAvailable: %llu", &kb) == 1) {
+        s->mem_avail_kb = kb;
+    } else if (sscanf(line, "SwapTotal: %llu", &kb) == 1) {
+        s->swap_total_kb = kb;
+    } else if (sscanf(line, "SwapFree: %llu", &kb) == 1) {
+        s->swap_free_kb = kb;
+    } else if (strncmp(line, "/proc/pressure/", 15) == 0) {
+        const char *res = line + 15;
+        if (strncmp(res, "cpu:", 4) == 0)         parse_psi_line(s, HOST_PSI_CPU, res);
+        else if (strncmp(res, "memory:", 7) == 0) parse_psi_line(s, HOST_PSI_MEM, res);
+        else if (strncmp(res, "io:", 3) == 0)     parse_psi_line(s, HOST_PSI_IO, res);
+    } else if (strncmp(line, "tasks ", 6) == 0) {
+        if (sscanf(line + 6, "%d %d %d %d %d %d", &s->tasks, &s->running, &s->sleeping,
+                   &s->disk, &s->zombie, &s->stopped) != 6) {
+            s->tasks = -1;
+        }
+    } else if (line[0] >= '0' && line[0] <= '9') {
+        sscanf(line, "%lf %lf %lf", &s->load[0], &s->load[1], &s->load[2]);
+    }
+}
+
+void host_sample_parse(host_sample_t *s, const char *buf, size_t len)
+{
+    char line[512];
+    size_t i = 0;
+
+    while (i < len) {
+        size_t j = i;
+        while (j < len && buf[j] != '\n') j++;
+        size_t n = j - i;
+        if (n >= sizeof(line)) n = sizeof(line) - 1;
+        memcpy(line, buf + i, n);
+        line[n] = '\0';
+        parse_line(s, line);
+        i = j + 1;
+    }
+}
+
+/* --- Source locale --- */
+
+/* Les lignes cpu sont en tête de /proc/stat, le reste (intr…) est ignoré */
+#define HOST_READ_BUF 32768
+
+struct host_source {
+    int stat_fd;
+    int meminfo_fd;
+    int loadavg_fd;
+    int psi_fd[HOST_PSI_COUNT];
+    char buf[HOST_READ_BUF];
+};
+
+static const char *psi_paths[HOST_PSI_COUNT] = {
+    "/proc/pressure/cpu", "/proc/pressure/memory", "/proc/pressure/io"
+};
+
+host_source_t *host_source_open(void)
+{
+    host_source_t *src = malloc(sizeof(host_source_t));
+    if (!src) {
+        perror("malloc host source");
+        return NULL;
+    }
+    src->stat_fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    src->meminfo_fd = open("/proc/meminfo", O_RDONLY | O_CLOEXEC);
+    src->loadavg_fd = open("/proc/loadavg", O_RDONLY | O_CLOEXEC);
+    for (int i = 0; i < HOST_PSI_COUNT; ++i) {
+        src->psi_fd[i] = open(psi_paths[i], O_RDONLY | O_CLOEXEC);
+    }
+    if (src->stat_fd < 0) {
+        host_source_close(src);
+        return NULL;
+    }
+    return src;
+}
+
+/* Relit le fichier depuis le début, sans le rouvrir */
+static ssize_t reread(host_source_t *src, int fd)
+{
+    if (fd < 0) return -1;
+    ssize_t n = pread(fd, src->buf, sizeof(src->buf) - 1, 0);
+    if (n < 0) return -1;
+    src->buf[n] = '\0';
+    return n;
+}
+
+int host_source_read(host_source_t *src, host_sample_t *out)
+{
+    host_sample_init(out);
+    if (!src) return -1;
+
+    ssize_t n = reread(src, src->stat_fd);
+    if (n < 0) return -1;
+    host_sample_parse(out, src->buf, (size_t)n);
+
+    if ((n = reread(src, src->meminfo_fd)) > 0) host_sample_parse(out, src->buf, (size_t)n);
+    if ((n = reread(src, src->loadavg_fd)) > 0) host_sample_parse(out, src->buf, (size_t)n);
+
+    /* Localement les lignes PSI n'ont pas le préfixe de grep -H */
+    for (int i = 0; i < HOST_PSI_COUNT; ++i) {
+        if (reread(src, src->psi_fd[i]) > 0) parse_psi_line(out, i, src->buf);
+    }
+    return 0;
+}
+
+void host_source_close(host_source_t *src)
+{
+    if (!src) return;
+    if (src->stat_fd >= 0) close(src->stat_fd);
+    if (src->meminfo_fd >= 0) close(src->meminfo_fd);
+    if (src->loadavg_fd >= 0) close(src->loadavg_fd);
+    for (int i = 0; i < HOST_PSI_COUNT; ++i) {
+        if (src->psi_fd[i] >= 0) close(src->psi_fd[i]);
+    }
+    free(src);
+}
+
+/* --- Résumé --- */
+
+void host_summary_update(host_summary_t *sum, const host_sample_t *s)
+{
+    if (!sum || !s || (s->cpu_count == 0 && s->mem_total_kb == 0)) return;
+
+    for (int i = 0; i <= s->cpu_count; ++i) {
+        sum->cpu_pct[i] = -1.0;
+        if (!sum->valid || i > sum->last.cpu_count) continue;
+
+        /* Compteurs remis à zéro (CPU remis en ligne) : inconnu ce tour-ci */
+        unsigned long long prev_total = sum->last.total[i];
+        unsigned long long prev_busy = sum->last.busy[i];
+        if (s->total[i] <= prev_total || s->busy[i] < prev_busy) continue;
+        sum->cpu_pct[i] = (double)(s->busy[i] - prev_busy) * 100.0 /
+                          (double)(s->total[i] - prev_total);
+    }
+    sum->last = *s;
+    sum->valid = 1;
+
+    /* États comptés par l'hôte lui-même, sur tous ses processus */
+    if (s->tasks >= 0) {
+        sum->tasks = s->tasks;
+        sum->running = s->running;
+        sum->sleeping = s->sleeping;
+        sum->disk = s->disk;
+        sum->zombie = s->zombie;
+        sum->stopped = s->stopped;
+    }
+}
+
+void host_summary_count_states(host_summary_t *sum, const process_info_t *rows, int count)
+{
+    if (!sum || (sum->valid && sum->last.tasks >= 0)) return;
+    sum->tasks = count;
+    sum->running = sum->sleeping = sum->disk = sum->zombie = sum->stopped = 0;
+    for (int i = 0; i < count; ++i) {
+        switch (rows[i].state) {
+        case 'R': sum->running++;  break;
+        case 'S':
+        case 'I': sum->sleeping++; break;
+        case 'D': sum->disk++;     break;
+        case 'Z': sum->zombie++;   break;
+        case 'T':
+        case 't': sum->stopped++;  break;
+        default:  break;
+        }
+    }
+}
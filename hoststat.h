@@ -0,0 +1,89 @@
+#ifndef HOSTSTAT_H
+#define HOSTSTAT_H
+
+#include <stddef.h>
+#include "process.h"
+
+/*
+ * Résumé de l'hôte affiché au-dessus de la liste : charge par CPU,
+ * mémoire et swap, load average, pression (PSI) et états des processus.
+ *
+ * Localement les fichiers /proc sont ouverts une fois et relus par
+ * pread(). Pour un hôte distant, HOST_SAMPLE_COMMAND suit ps dans la même
+ * commande ssh : sa sortie n'a pas besoin d'une connexion de plus.
+ */
+
+#define HOST_MAX_CPUS 256
+
+/* Lignes auto-descriptives (cpu…, Clé:, loadavg, fichier:some …, tasks).
+ * "tasks N R S D Z T" compte les états de tous les processus : le ps de
+ * la collecte peut être filtré et tronqué. Passe entre guillemets
+ * doubles par le shell local, d'où les \$ et \". */
+#define HOST_SAMPLE_COMMAND \
+    "grep ^cpu /proc/stat; " \
+    "grep -E '^(MemTotal|MemAvailable|SwapTotal|SwapFree):' /proc/meminfo; " \
+    "cat /proc/loadavg; " \
+    "grep -H some /proc/pressure/* 2>/dev/null; " \
+    "ps -eo stat= | awk '{s[substr(\\$1, 1, 1)]++} END {print \\\"tasks\\\", NR, " \
+    "s[\\\"R\\\"]+0, s[\\\"S\\\"]+s[\\\"I\\\"], s[\\\"D\\\"]+0, s[\\\"Z\\\"]+0, s[\\\"T\\\"]+s[\\\"t\\\"]}'"
+
+enum {
+    HOST_PSI_CPU = 0,
+    HOST_PSI_MEM,
+    HOST_PSI_IO,
+    HOST_PSI_COUNT
+};
+
+/* Compteurs bruts d'un instant */
+typedef struct {
+    int cpu_count;              /* lignes cpuN lues, 0 = pas de /proc/stat */
+    unsigned long long busy[HOST_MAX_CPUS + 1];     /* [0] : ligne "cpu" agrégée */
+    unsigned long long total[HOST_MAX_CPUS + 1];
+    unsigned long long mem_total_kb;
+    unsigned long long mem_avail_kb;
+    unsigned long long swap_total_kb;
+    unsigned long long swap_free_kb;
+    double load[3];             /* < 0 = absent */
+    double psi[HOST_PSI_COUNT]; /* "some avg10" en %, < 0 = absent (noyau sans PSI) */
+    int tasks;                  /* ligne "tasks", < 0 = absente (compter le snapshot) */
+    int running;
+    int sleeping;
+    int disk;
+    int zombie;
+    int stopped;
+} host_sample_t;
+
+/* Ce qu'affiche l'entête d'un onglet */
+typedef struct {
+    int valid;                  /* au moins un échantillon */
+    host_sample_t last;
+    double cpu_pct[HOST_MAX_CPUS + 1];  /* depuis l'échantillon précédent, < 0 = inconnu */
+    int tasks;                  /* états comptés sur le snapshot complet */
+    int running;
+    int sleeping;
+    int disk;                   /* D : sommeil non interruptible */
+    int zombie;
+    int stopped;
+} host_summary_t;
+
+void host_sample_init(host_sample_t *s);
+
+/* Lignes de /proc/stat, /proc/meminfo, /proc/loadavg et de
+ * "grep -H some" sur les fichiers de /proc/pressure, dans n'importe quel ordre */
+void host_sample_parse(host_sample_t *s, const char *buf, size_t len);
+
+typedef struct host_source host_source_t;
+
+/* Fichiers /proc locaux gardés ouverts ; NULL si /proc/stat est illisible */
+host_source_t *host_source_open(void);
+int host_source_read(host_source_t *src, host_sample_t *out);
+void host_source_close(host_source_t *src);
+
+/* Nouvel échantillon : %CPU calculés à partir des deltas de compteurs */
+void host_summary_update(host_summary_t *sum, const host_sample_t *s);
+
+/* États R / S / D / Z / T du snapshot, avant le filtre d'affichage ;
+ * sans effet si le dernier échantillon portait sa ligne "tasks" */
+void host_summary_count_states(host_summary_t *sum, const process_info_t *rows, int count);
+
+#endif
@@ -0,0 +1,284 @@
+#define _POSIX_C_SOURCE 200809L
+#include "hot.h"
+#include "filter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Un seul bloc aligné sur une ligne de cache : cpu, mem, pid, state.
+ * cap multiple de 16, chaque colonne reste alignée sur 64 octets. */
+int hot_columns_build(hot_columns_t *h, const process_info_t *rows, int count)
+{
+    if (!h) return -1;
+    if (count < 0) count = 0;
+
+    if (count > h->cap || !h->cpu) {
+        int cap = (count + 15) & ~15;
+        if (cap == 0) cap = 16;
+        size_t bytes = (size_t)cap * (2 * sizeof(double) + sizeof(int) + sizeof(char));
+        void *block;
+        if (posix_memalign(&block, 64, bytes) != 0) {
+            perror("posix_memalign hot columns");
+            h->count = 0;
+            return -1;
+        }
+        free(h->cpu);
+        h->cap = cap;
+        h->cpu = block;
+        h->mem = h->cpu + cap;
+        h->pid = (int *)(h->mem + cap);
+        h->state = (char *)(h->pid + cap);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        h->cpu[i] = rows[i].cpu_usage;
+        h->mem[i] = rows[i].mem_usage;
+        h->pid[i] = rows[i].pid;
+        h->state[i] = rows[i].state;
+    }
+    h->count = count;
+    h->cpu_total = hot_sum(h->cpu, count);
+    h->mem_total = hot_sum(h->mem, count);
+    return 0;
+}
+
+void hot_columns_free(hot_columns_t *h)
+{
+    if (!h) return;
+    free(h->cpu);
+    memset(h, 0, sizeof(*h));
+}
+
+double hot_sum(const double *v, int n)
+{
+    double s = 0.0;
+    int i = 0;
+#if defined(__SSE2__)
+    /* Quatre accumulateurs : l'addition suivante n'attend pas la précédente */
+    __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+    __m128d a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm_add_pd(a0, _mm_loadu_pd(v + i));
+        a1 = _mm_add_pd(a1, _mm_loadu_pd(v + i + 2));
+        a2 = _mm_add_pd(a2, _mm_loadu_pd(v + i + 4));
+        a3 = _mm_add_pd(a3, _mm_loadu_pd(v + i + 6));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(_mm_add_pd(a0, a1), _mm_add_pd(a2, a3)));
+    s = lanes[0] + lanes[1];
+#endif
+    for (; i < n; ++i) s += v[i];
+    return s;
+}
+
+#if defined(__SSE2__)
+/* Écriture sans branche : l'indice est toujours posé, le compteur
+ * n'avance que si le test est vrai (out a n places, c <= i) */
+#define SELECT_LOOP(CMP)                                                \
+    for (; i + 2 <= n; i += 2) {                                        \
+        int m = _mm_movemask_pd(CMP(_mm_loadu_pd(v + i), r));           \
+        out[c] = i;                                                     \
+        c += m & 1;                                                     \
+        out[c] = i + 1;                                                 \
+        c += m >> 1;                                                    \
+    }
+#endif
+
+int hot_select(const double *v, int n, unsigned char op, double ref, int *out)
+{
+    int i = 0, c = 0;
+#if defined(__SSE2__)
+    __m128d r = _mm_set1_pd(ref);
+    switch (op) {
+    case FO_LT: SELECT_LOOP(_mm_cmplt_pd);  break;
+    case FO_LE: SELECT_LOOP(_mm_cmple_pd);  break;
+    case FO_GT: SELECT_LOOP(_mm_cmpgt_pd);  break;
+    case FO_GE: SELECT_LOOP(_mm_cmpge_pd);  break;
+    case FO_EQ: SELECT_LOOP(_mm_cmpeq_pd);  break;
+    case FO_NE: SELECT_LOOP(_mm_cmpneq_pd); break;
+    default:    return 0;
+    }
+#endif
+    for (; i < n; ++i) {
+        out[c] = i;
+        c += filter_cmp_num(v[i], op, ref);
+    }
+    return c;
+}
+
+int hot_next_ge(const double *v, int from, int n, double ref)
+{
+    int i = from;
+#if defined(__SSE2__)
+    __m128d r = _mm_set1_pd(ref);
+    for (; i + 4 <= n; i += 4) {
+        int m = _mm_movemask_pd(_mm_cmpge_pd(_mm_loadu_pd(v + i), r)) |
+                _mm_movemask_pd(_mm_cmpge_pd(_mm_loadu_pd(v + i + 2), r)) << 2;
+        if (m) {
+            while (!(m & 1)) {
+                m >>= 1;
+                i++;
+            }
+            return i;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (v[i] >= ref) return i;
+    }
+    return n;
+}
+
+/* a passe avant b ? (clé décroissante, puis pid croissant) */
+static int key_before(const double *key, const int *pid, int a, int b)
+{
+    if (key[a] != key[b]) return key[a] > key[b];
+    return pid ? pid[a] < pid[b] : a < b;
+}
+
+static void swap_int(int *a, int *b)
+{
+    int t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/* Tas min borné : heap[0] est le moins bon des k meilleurs */
+static void heap_sift_down(int *heap, int n, int i, const double *key, const int *pid)
+{
+    for (;;) {
+        int l = 2 * i + 1;
+        int r = l + 1;
+        int worst = i;
+        if (l < n && key_before(key, pid, heap[worst], heap[l])) worst = l;
+        if (r < n && key_before(key, pid, heap[worst], heap[r])) worst = r;
+        if (worst == i) return;
+        swap_int(&heap[i], &heap[worst]);
+        i = worst;
+    }
+}
+
+static void heap_sift_up(int *heap, int i, const double *key, const int *pid)
+{
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!key_before(key, pid, heap[parent], heap[i])) return;
+        swap_int(&heap[i], &heap[parent]);
+        i = parent;
+    }
+}
+
+int hot_topk(const double *key, const int *pid, int n, int k, int *out)
+{
+    int size = 0;
+    int i = 0;
+
+    for (; i < n && size < k; ++i) {
+        out[size] = i;
+        heap_sift_up(out, size, key, pid);
+        size++;
+    }
+
+    /* Seules les lignes au moins égales au k-ième passent le tas ;
+     * les autres sont sautées par blocs */
+    while (size > 0 && i < n) {
+        i = hot_next_ge(key, i, n, key[out[0]]);
+        if (i >= n) break;
+        if (key_before(key, pid, i, out[0])) {
+            out[0] = i;
+            heap_sift_down(out, size, 0, key, pid);
+        }
+        i++;
+    }
+
+    /* Tri final du tas : on extrait le pire à la fin */
+    for (int end = size - 1; end > 0; --end) {
+        swap_int(&out[0], &out[end]);
+        heap_sift_down(out, end, 0, key, pid);
+    }
+    return size;
+}
+
+/* Entier dont l'ordre croissant est l'ordre décroissant des clés */
+static unsigned long long sort_bits(double d)
+{
+    unsigned long long u;
+    memcpy(&u, &d, sizeof(u));
+    u = (u >> 63) ? ~u : (u | 0x8000000000000000ULL);
+    return ~u;
+}
+
+/* Chiffre b (0 à 11) de la clé composée de la ligne i : les 4 octets
+ * du pid d'abord, les 8 de la clé ensuite (tri par base LSD) */
+static unsigned digit_of(const unsigned long long *k, const int *pid, int i, int row, int b)
+{
+    if (b < 4) return ((unsigned)pid[row] >> (8 * b)) & 255;
+    return (k[i] >> (8 * (b - 4))) & 255;
+}
+
+/* Tri par base (passes d'un octet, stables) sur la clé puis le pid ; les
+ * octets identiques sur toutes les lignes sont sautés : les %CPU n'en
+ * varient que sur quelques-uns. Les passes sur le pid sont inutiles si
+ * les lignes sont déjà dans l'ordre des pid (cas de /proc). */
+int hot_sort_desc(const double *key, const int *pid, int n, int *out)
+{
+    if (n <= 0) return 0;
+
+    unsigned long long *keys = malloc((size_t)n * 2 * sizeof(unsigned long long));
+    int *tmp = malloc((size_t)n * sizeof(int));
+    int (*hist)[256] = calloc(12, sizeof(*hist));
+    if (!keys || !tmp || !hist) {
+        perror("malloc hot sort");
+        free(keys);
+        free(tmp);
+        free(hist);
+        return -1;
+    }
+
+    int first = 4;
+    for (int i = 1; pid && i < n; ++i) {
+        if (pid[i] < pid[i - 1]) {
+            first = 0;
+            break;
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        unsigned long long k = sort_bits(key[i]);
+        keys[i] = k;
+        out[i] = i;
+        for (int b = first; b < 12; ++b) hist[b][digit_of(keys, pid, i, i, b)]++;
+    }
+
+    unsigned long long *ka = keys, *kb = keys + n;
+    int *ia = out, *ib = tmp;
+    for (int b = first; b < 12; ++b) {
+        if (hist[b][digit_of(ka, pid, 0, ia[0], b)] == n) continue;
+
+        int pos[256];
+        int sum = 0;
+        for (int d = 0; d < 256; ++d) {
+            pos[d] = sum;
+            sum += hist[b][d];
+        }
+        for (int i = 0; i < n; ++i) {
+            int p = pos[digit_of(ka, pid, i, ia[i], b)]++;
+            kb[p] = ka[i];
+            ib[p] = ia[i];
+        }
+
+        unsigned long long *kt = ka; ka = kb; kb = kt;
+        int *it = ia; ia = ib; ib = it;
+    }
+    if (ia != out) memcpy(out, ia, (size_t)n * sizeof(int));
+
+    free(keys);
+    free(tmp);
+    free(hist);
+    return n;
+}
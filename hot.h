@@ -0,0 +1,50 @@
+#ifndef HOT_H
+#define HOT_H
+
+#include "process.h"
+
+/*
+ * Colonnes numériques "chaudes" d'un snapshot, en tableaux séparés et
+ * alignés : un parcours sur %CPU lit 8 octets par ligne au lieu de la
+ * structure process_info_t entière.
+ *
+ * Les noyaux (somme, sélection par seuil, top-K) utilisent SSE2 quand le
+ * compilateur le fournit (toujours le cas en x86-64), une boucle scalaire
+ * sinon.
+ */
+
+typedef struct {
+    int count;
+    int cap;
+    double *cpu;
+    double *mem;
+    int *pid;
+    char *state;
+    double cpu_total;           /* sommes, recalculées à chaque construction */
+    double mem_total;
+} hot_columns_t;
+
+/* (Re)construit les colonnes à partir des lignes ; réutilise la mémoire */
+int  hot_columns_build(hot_columns_t *h, const process_info_t *rows, int count);
+void hot_columns_free(hot_columns_t *h);
+
+double hot_sum(const double *v, int n);
+
+/* Indices i tels que v[i] op ref (op : FO_LT .. FO_NE de filter.h),
+ * croissants, dans out (n places). Retourne leur nombre. */
+int hot_select(const double *v, int n, unsigned char op, double ref, int *out);
+
+/* Premier i >= from tel que v[i] >= ref, n si aucun */
+int hot_next_ge(const double *v, int from, int n, double ref);
+
+/* Les deux tris classent par clé décroissante puis pid croissant (pid
+ * peut être NULL : ordre des lignes), comme le classement de la flotte.
+ * top=N et sort= seul donnent ainsi les mêmes premières lignes. */
+
+/* k meilleurs indices, triés, dans out (k places) */
+int hot_topk(const double *key, const int *pid, int n, int k, int *out);
+
+/* Indices 0..n-1 triés, dans out */
+int hot_sort_desc(const double *key, const int *pid, int n, int *out);
+
+#endif
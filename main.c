@@ -1,376 +1,1344 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <signal.h>
-#include <getopt.h>
-
-#include "ui.h"
-#include "process.h"
-#include "network.h"
-
-static void print_help(const char *prog)
-{
-    printf("Usage: %s [options]\n", prog);
-    printf("Network process manager (local + remote via ssh).\n\n");
-    printf("Options:\n");
-    printf("  -h, --help               Show this help and exit.\n");
-    printf("      --dry-run            Test local process listing then exit.\n");
-    printf("  -c, --remote-config FILE Use remote config file.\n");
-    printf("  -s, --remote-server HOST Add one remote server.\n");
-    printf("  -u, --username USER      Username for remote server.\n");
-    printf("  -p, --password PASS      Password (stockée mais non passée à ssh).\n");
-    printf("  -a, --all                Show local and all remote machines.\n");
-}
-
-static int list_to_array(process_list *list, process_info_t **out)
-{
-    if (!list) return 0;
-
-    int count = 0;
-    process_elem *cur = list->head;
-    while (cur) {
-        count++;
-        cur = cur->next;
-    }
-
-    if (count == 0) {
-        *out = NULL;
-        return 0;
-    }
-
-    process_info_t *arr = malloc(sizeof(process_info_t) * (size_t)count);
-    if (!arr) {
-        perror("malloc processes");
-        *out = NULL;
-        return 0;
-    }
-
-    cur = list->head;
-    int i = 0;
-    while (cur && i < count) {
-        arr[i] = cur->process;
-        i++;
-        cur = cur->next;
-    }
-
-    *out = arr;
-    return count;
-}
-
-static int refresh_local(ui_context_t *ctx)
-{
-    if (!ctx || ctx->tab_count == 0 || !ctx->tabs) {
-        return -1;
-    }
-
-    machine_tab_t *tab = &ctx->tabs[0];
-    process_list *list = create_process_list();
-    if (!list) {
-        return -1;
-    }
-
-    int old_selected_pid = -1;
-    if (tab->processes &&
-        tab->process_count > 0 &&
-        tab->selected_proc_index >= 0 &&
-        tab->selected_proc_index < tab->process_count) {
-        old_selected_pid = tab->processes[tab->selected_proc_index].pid;
-    }
-
-    free(tab->processes);
-    tab->processes = NULL;
-    tab->process_count = 0;
-
-    tab->process_count = list_to_array(list, &tab->processes);
-    free_process_list(list);
-
-    tab->selected_proc_index = 0;
-    if (old_selected_pid != -1) {
-        for (int i = 0; i < tab->process_count; ++i) {
-            if (tab->processes[i].pid == old_selected_pid) {
-                tab->selected_proc_index = i;
-                break;
-            }
-        }
-        if (tab->selected_proc_index >= tab->process_count) {
-            tab->selected_proc_index = tab->process_count - 1;
-        }
-        if (tab->selected_proc_index < 0) {
-            tab->selected_proc_index = 0;
-        }
-    }
-
-    ctx->scroll_offset = 0;
-    return 0;
-}
-
-static int refresh_remote_tab(ui_context_t *ctx,
-                              int tab_index,
-                              const remotemachine_t *m)
-{
-    if (!ctx || !ctx->tabs || tab_index <= 0 || tab_index >= ctx->tab_count) {
-        return -1;
-    }
-    if (!m) return -1;
-
-    machine_tab_t *tab = &ctx->tabs[tab_index];
-
-    process_list *list = fetch_remote_processes(m);
-    if (!list) {
-        return -1;
-    }
-
-    int old_selected_pid = -1;
-    if (tab->processes &&
-        tab->process_count > 0 &&
-        tab->selected_proc_index >= 0 &&
-        tab->selected_proc_index < tab->process_count) {
-        old_selected_pid = tab->processes[tab->selected_proc_index].pid;
-    }
-
-    free(tab->processes);
-    tab->processes = NULL;
-    tab->process_count = 0;
-
-    tab->process_count = list_to_array(list, &tab->processes);
-    free_process_list(list);
-
-    tab->selected_proc_index = 0;
-    if (old_selected_pid != -1) {
-        for (int i = 0; i < tab->process_count; ++i) {
-            if (tab->processes[i].pid == old_selected_pid) {
-                tab->selected_proc_index = i;
-                break;
-            }
-        }
-        if (tab->selected_proc_index >= tab->process_count) {
-            tab->selected_proc_index = tab->process_count - 1;
-        }
-        if (tab->selected_proc_index < 0) {
-            tab->selected_proc_index = 0;
-        }
-    }
-
-    ctx->scroll_offset = 0;
-    return 0;
-}
-
-static void send_signal_selected(ui_context_t *ctx, int signum, remotemachine_t *remotes)
-{
-    if (!ctx || ctx->tab_count == 0 || !ctx->tabs) {
-        return;
-    }
-
-    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
-    if (tab->process_count == 0 ||
-        tab->selected_proc_index < 0 ||
-        tab->selected_proc_index >= tab->process_count) {
-        return;
-    }
-
-    int pid = tab->processes[tab->selected_proc_index].pid;
-
-    if (ctx->current_tab_index == 0) {
-        /* Onglet 0 : Local -> on utilise kill() système */
-        kill(pid, signum);
-    } else {
-        /* Onglet > 0 : Distant -> on utilise notre nouvelle fonction SSH */
-        /* L'onglet 1 correspond à remotes[0], l'onglet 2 à remotes[1], etc. */
-        if (remotes) {
-            send_remote_signal(&remotes[ctx->current_tab_index - 1], pid, signum);
-        }
-    }
-}
-
-static struct option long_options[] = {
-    {"help",          no_argument,       0, 'h'},
-    {"dry-run",       no_argument,       0,  1 },
-    {"remote-config", required_argument, 0, 'c'},
-    {"remote-server", required_argument, 0, 's'},
-    {"username",      required_argument, 0, 'u'},
-    {"password",      required_argument, 0, 'p'},
-    {"all",           no_argument,       0, 'a'},
-    {0, 0, 0, 0}
-};
-
-int main(int argc, char **argv)
-{
-    ui_context_t ctx;
-    memset(&ctx, 0, sizeof(ctx));
-
-    remotemachine_t *remotes = NULL;
-    size_t remote_count = 0;
-
-    char *conf_path  = NULL;
-    char *cli_server = NULL;
-    char *cli_user   = NULL;
-    char *cli_pass   = NULL;
-    int include_all  = 0;
-    int dry_run      = 0;
-
-    int opt, opt_index = 0;
-    while ((opt = getopt_long(argc, argv, "hc:s:u:p:a", long_options, &opt_index)) != -1) {
-        switch (opt) {
-        case 'h':
-            print_help(argv[0]);
-            return EXIT_SUCCESS;
-        case 1:
-            dry_run = 1;
-            break;
-        case 'c':
-            conf_path = optarg;
-            break;
-        case 's':
-            cli_server = optarg;
-            break;
-        case 'u':
-            cli_user = optarg;
-            break;
-        case 'p':
-            cli_pass = optarg;
-            break;
-        case 'a':
-            include_all = 1;
-            break;
-        default:
-            print_help(argv[0]);
-            return EXIT_FAILURE;
-        }
-    }
-
-    if (dry_run) {
-        process_list *list = create_process_list();
-        if (!list) {
-            fprintf(stderr, "Failed to get process list.\n");
-            return EXIT_FAILURE;
-        }
-        free_process_list(list);
-        printf("Local process listing: OK\n");
-        return EXIT_SUCCESS;
-    }
-
-    if (conf_path) {
-        load_remote_config(conf_path, &remotes, &remote_count);
-    }
-
-    if (cli_server) {
-        add_remote_machine(&remotes, &remote_count,
-                           cli_server, cli_server, 22,
-                           cli_user, cli_pass, "ssh");
-    }
-
-    /* Initialisation des onglets : au moins la machine locale */
-    ctx.tabs = malloc(sizeof(machine_tab_t) * (1 + (include_all ? (int)remote_count : 0)));
-    if (!ctx.tabs) {
-        perror("malloc tabs");
-        free(remotes);
-        return EXIT_FAILURE;
-    }
-    memset(ctx.tabs, 0, sizeof(machine_tab_t) * (1 + (include_all ? (int)remote_count : 0)));
-
-    ctx.tab_count = 1;
-    ctx.current_tab_index = 0;
-    ctx.running = 1;
-    ctx.scroll_offset = 0;
-
-    machine_tab_t *local_tab = &ctx.tabs[0];
-    snprintf(local_tab->hostname, sizeof(local_tab->hostname), "Local");
-    local_tab->processes = NULL;
-    local_tab->process_count = 0;
-    local_tab->selected_proc_index = 0;
-
-    if (refresh_local(&ctx) != 0) {
-        fprintf(stderr, "Unable to get local process list.\n");
-        free(ctx.tabs);
-        free(remotes);
-        return EXIT_FAILURE;
-    }
-
-    /* Onglets distants si demandé */
-    if (include_all && remote_count > 0) {
-        for (size_t i = 0; i < remote_count; ++i) {
-            machine_tab_t *tab = &ctx.tabs[ctx.tab_count];
-            const remotemachine_t *m = &remotes[i];
-
-            if (m->name[0] != '\0')
-                snprintf(tab->hostname, sizeof(tab->hostname), "%s", m->name);
-            else
-                snprintf(tab->hostname, sizeof(tab->hostname), "%s", m->host);
-
-            tab->processes = NULL;
-            tab->process_count = 0;
-            tab->selected_proc_index = 0;
-
-            process_list *rlist = fetch_remote_processes(m);
-            if (rlist) {
-                tab->process_count = list_to_array(rlist, &tab->processes);
-                free_process_list(rlist);
-            }
-
-            ctx.tab_count++;
-        }
-    }
-
-    ui_init();
-
-    while (ctx.running) {
-        ui_draw(&ctx);
-        int action = ui_input(&ctx);
-
-        switch (action) {
-        case KEY_F(1):
-            ui_show_help_screen(&ctx);
-            break;
-        case KEY_F(4):
-            ui_search_process_by_name(&ctx);
-            break;
-        case KEY_F(5):
-            send_signal_selected(&ctx, SIGSTOP, remotes);
-            /* Rafraichissement intelligent : si local on refresh local, sinon remote */
-            if (ctx.current_tab_index == 0) refresh_local(&ctx);
-            else refresh_remote_tab(&ctx, ctx.current_tab_index, &remotes[ctx.current_tab_index - 1]);
-            break;
-
-        case KEY_F(6):
-            send_signal_selected(&ctx, SIGTERM, remotes);
-            if (ctx.current_tab_index == 0) refresh_local(&ctx);
-            else refresh_remote_tab(&ctx, ctx.current_tab_index, &remotes[ctx.current_tab_index - 1]);
-            break;
-
-        case KEY_F(7):
-            send_signal_selected(&ctx, SIGKILL, remotes);
-            if (ctx.current_tab_index == 0) refresh_local(&ctx);
-            else refresh_remote_tab(&ctx, ctx.current_tab_index, &remotes[ctx.current_tab_index - 1]);
-            break;
-
-        case KEY_F(8):
-            send_signal_selected(&ctx, SIGCONT, remotes);
-            if (ctx.current_tab_index == 0) refresh_local(&ctx);
-            else refresh_remote_tab(&ctx, ctx.current_tab_index, &remotes[ctx.current_tab_index - 1]);
-            break;
-        case KEY_F(9):
-            /* Refresh local et remotes */
-            refresh_local(&ctx);
-            if (include_all && remote_count > 0) {
-                for (int t = 1; t < ctx.tab_count; ++t) {
-                    refresh_remote_tab(&ctx, t, &remotes[t - 1]);
-                }
-            }
-            break;
-        default:
-            break;
-        }
-    }
-
-    ui_clean();
-
-    if (ctx.tabs) {
-        for (int i = 0; i < ctx.tab_count; ++i) {
-            free(ctx.tabs[i].processes);
-        }
-        free(ctx.tabs);
-    }
-    free(remotes);
-
-    return EXIT_SUCCESS;
-}
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <getopt.h>
+#include <time.h>
+
+#include "ui.h"
+#include "process.h"
+#include "network.h"
+#include "fleet.h"
+#include "cgroup.h"
+#include "columns.h"
+#include "record.h"
+#include "rules.h"
+#include "daemon.h"
+#include "shm.h"
+#include "sched.h"
+#include "action.h"
+#include "transport.h"
+#include "smaps.h"
+
+/* Programme lancé par --via sur le bastion */
+#define RELAY_DEFAULT_COMMAND "process_manager"
+
+static void print_help(const char *prog)
+{
+    printf("Usage: %s [options]\n", prog);
+    printf("Network process manager (local + remote via ssh).\n\n");
+    printf("Options:\n");
+    printf("  -h, --help               Show this help and exit.\n");
+    printf("      --dry-run            Test local process listing then exit.\n");
+    printf("  -c, --remote-config FILE Use remote config file, lines\n");
+    printf("                           name:address:port:user:pass:type with type\n");
+    printf("                           ssh, local or sim (simulated host).\n");
+    printf("  -s, --remote-server HOST Add one remote server.\n");
+    printf("  -u, --username USER      Username for remote server.\n");
+    printf("  -p, --password PASS      Password (stockée mais non passée à ssh).\n");
+    printf("  -a, --all                Show local and all remote machines.\n");
+    printf("  -f, --filter QUERY       Collect only matching processes, e.g.\n");
+    printf("                           \"user==postgres && cpu>5 || state==D sort=cpu top=50\".\n");
+    printf("                           sort=cpu, mem or pss (PSS: local tab only).\n");
+    printf("  -k, --top-k N            Rows kept in the \"All hosts\" tab (default %d).\n",
+           FLEET_DEFAULT_K);
+    printf("      --record FILE        Append every snapshot to FILE (and FILE.idx).\n");
+    printf("      --replay FILE        Browse a recording; [ ] and { } move in time.\n");
+    printf("      --rules FILE         Watch rules checked on every snapshot, e.g.\n");
+    printf("                           \"cpu>90 for 30s\", \"state==Z count>10\". Remote\n");
+    printf("                           hosts then send all their processes (no -f pushdown).\n");
+    printf("  -C, --columns LIST       Displayed columns, among pid,user,cpu,mem,state,\n");
+    printf("                           rss,vsz,pss,uss,swap,nice,prio,start,read,write,\n");
+    printf("                           fds,command,cmdline. Extended ones are local only.\n");
+    printf("      --batch              Print the filtered processes (-f, -C) and exit.\n");
+    printf("      --daemon             Collect once for every viewer on this host\n");
+    printf("                           (foreground; other instances connect to it).\n");
+    printf("      --socket PATH        Daemon socket (default $XDG_RUNTIME_DIR/\n");
+    printf("                           process_manager.sock).\n");
+    printf("      --no-daemon          Collect directly even if a daemon is running.\n");
+    printf("      --interval MS        Refresh period of the visible tab (default %d,\n",
+           SCHED_DEFAULT_INTERVAL_MS);
+    printf("                           0 = only on F9); others refresh less often.\n");
+    printf("      --budget PCT         CPU budget for collection, %% of one core\n");
+    printf("                           (default %.0f, 0 = unlimited).\n", SCHED_DEFAULT_BUDGET);
+    printf("      --shm[=NAME]         Publish the local snapshot in POSIX shared memory\n");
+    printf("                           (default /process_manager-UID, see shm.h).\n");
+    printf("      --relay              Collect all hosts of -c and stream them on\n");
+    printf("                           stdin/stdout (run by --via on a bastion).\n");
+    printf("      --via [USER@]HOST[:PORT]\n");
+    printf("                           Watch the hosts through a relay on HOST, over a\n");
+    printf("                           single ssh connection; -c, -f, --interval and\n");
+    printf("                           --budget are passed to the relay.\n");
+    printf("      --relay-command CMD  Program started on the bastion (default\n");
+    printf("                           \"%s\").\n", RELAY_DEFAULT_COMMAND);
+}
+
+static int list_to_array(process_list *list, process_info_t **out)
+{
+    if (!list) return 0;
+
+    int count = 0;
+    process_elem *cur = list->head;
+    while (cur) {
+        count++;
+        cur = cur->next;
+    }
+
+    if (count == 0) {
+        *out = NULL;
+        return 0;
+    }
+
+    process_info_t *arr = malloc(sizeof(process_info_t) * (size_t)count);
+    if (!arr) {
+        perror("malloc processes");
+        *out = NULL;
+        return 0;
+    }
+
+    cur = list->head;
+    int i = 0;
+    while (cur && i < count) {
+        arr[i] = cur->process;
+        i++;
+        cur = cur->next;
+    }
+
+    *out = arr;
+    return count;
+}
+
+/* Enregistrement en cours (--record), NULL sinon */
+static recorder_t *recorder;
+
+/* Règles de surveillance (--rules), NULL sinon */
+static rules_t *rules;
+
+/* Démon (--daemon) ou relais (--relay) servant les snapshots, NULL sinon */
+static daemon_server_t *server;
+
+/* Connexion à un démon : les snapshots viennent de lui, NULL sinon */
+static daemon_client_t *viewer;
+
+/* Publication du snapshot local en mémoire partagée (--shm), NULL sinon */
+static shm_writer_t *publisher;
+
+/* Rafraîchissement automatique, NULL en relecture et derrière un démon */
+static sched_t *sched;
+
+/* /proc/stat, meminfo, loadavg, pressure gardés ouverts pour l'onglet local */
+static host_source_t *local_host;
+
+/* Signaux en attente ou en cours d'envoi, par lots ssh */
+static action_queue_t *actions;
+
+/* Relais (--via) : bastion d'où viennent les snapshots, NULL sinon */
+static const char *via;
+
+/* PSS / USS / swap des processus locaux affichés ou triés, session interactive */
+static smaps_cache_t *smaps;
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Filtre poussé aux hôtes distants. Les règles doivent voir tous les
+ * processus : pas de filtre ni de limite distants quand il y en a, le
+ * filtre d'affichage est alors appliqué ici par install_array(). */
+static const process_query_t *remote_query(const ui_context_t *ctx)
+{
+    return rules ? NULL : &ctx->query;
+}
+
+/* Remplace le snapshot d'un onglet (arr est repris) en conservant le PID sélectionné.
+ * ts_ms : date du snapshot, pour les durées des règles de surveillance. */
+static void install_array(ui_context_t *ctx, machine_tab_t *tab,
+                          process_info_t *arr, int count, long long ts_ms)
+{
+    /* Règles évaluées sur le snapshot complet, avant le filtre d'affichage */
+    char alert[128];
+    if (rules && rules_eval(rules, (int)(tab - ctx->tabs), tab->hostname, (double)ts_ms / 1000.0,
+                            arr, count, alert, sizeof(alert)) > 0) {
+        snprintf(ctx->status_msg, sizeof(ctx->status_msg), "%s", alert);
+    }
+
+    /* PIDs apparus / disparus : rythme de rafraîchissement de l'hôte. Un
+     * distant dont ps a été filtré ou tronqué ne montre pas son churn. */
+    if (tab->kind == TAB_LOCAL || !remote_query(ctx) ||
+        (ctx->query.filter.code_len == 0 && ctx->query.limit <= 0)) {
+        sched_observe(sched, (int)(tab - ctx->tabs), arr, count);
+    }
+
+    /* États de tout l'hôte, pas seulement des lignes filtrées (un hôte
+     * distant les envoie dans son échantillon : son ps est déjà filtré) */
+    host_summary_count_states(&tab->summary, arr, count);
+
+    int old_selected_pid = -1;
+    if (tab->processes &&
+        tab->process_count > 0 &&
+        tab->selected_proc_index >= 0 &&
+        tab->selected_proc_index < tab->process_count) {
+        old_selected_pid = tab->processes[tab->selected_proc_index].pid;
+    }
+
+    /* sort=pss : valeurs en cache, tout l'onglet est relu en tâche de fond */
+    if (ctx->query.sort == PROC_SORT_PSS && tab->kind == TAB_LOCAL) {
+        for (int i = 0; i < count; ++i) smaps_cache_fill(smaps, &arr[i], 0);
+    }
+
+    /* Les distants ont déjà filtré, on ré-applique pour les cas non
+     * traduisibles en arguments ps (et pour l'onglet local) */
+    count = process_array_apply_query(arr, count, &ctx->query);
+
+
+    free(tab->processes);
+    tab->processes = arr;
+    tab->process_count = count;
+
+    tab->selected_proc_index = 0;
+    if (old_selected_pid != -1) {
+        for (int i = 0; i < tab->process_count; ++i) {
+            if (tab->processes[i].pid == old_selected_pid) {
+                tab->selected_proc_index = i;
+                break;
+            }
+        }
+        if (tab->selected_proc_index >= tab->process_count) {
+            tab->selected_proc_index = tab->process_count - 1;
+        }
+        if (tab->selected_proc_index < 0) {
+            tab->selected_proc_index = 0;
+        }
+    }
+
+    /* Totaux de groupes mis à jour à partir des deltas par PID */
+    ui_tab_updated(tab);
+
+    /* Seul le run de cet onglet est reclassé avant la fusion */
+    if (ctx->fleet_tab_index >= 0) {
+        fleet_rank_tab(tab, ctx->fleet_k);
+        fleet_merge(ctx);
+    }
+
+    /* Le défilement est recalé sur la sélection par ui_draw() */
+    tab->loaded = 1;
+}
+
+static void install_snapshot(ui_context_t *ctx, machine_tab_t *tab, process_list *list)
+{
+    process_info_t *arr = NULL;
+    int count = list_to_array(list, &arr);
+    free_process_list(list);
+
+    /* Snapshot brut, avant le filtre d'affichage */
+    long long ts = now_ms();
+    if (recorder) {
+        record_write(recorder, (int)(tab - ctx->tabs), ts, arr, count);
+    }
+    if (server) {
+        daemon_publish(server, (int)(tab - ctx->tabs), ts, arr, count);
+    }
+    if (publisher && tab->kind == TAB_LOCAL) {
+        shm_publish(publisher, ts, arr, count);
+    }
+    install_array(ctx, tab, arr, count, ts);
+}
+
+/* Remplace les tâches affichées ; le %CPU est le delta depuis la liste précédente */
+static void install_threads(machine_tab_t *tab, thread_list_t *tl)
+{
+    if (tl && tab->expanded_pid != tl->pid) {
+        free_thread_list(tl);
+        tl = NULL;
+    }
+
+    thread_list_update_usage(tl, tab->threads);
+    free_thread_list(tab->threads);
+    tab->threads = tl;
+}
+
+/* Installe le dernier snapshot reçu du démon pour un onglet */
+static void install_from_viewer(ui_context_t *ctx, int t, long long ts_ms, int record)
+{
+    machine_tab_t *tab = &ctx->tabs[t];
+    process_info_t *arr;
+    int count;
+    if (daemon_client_rows(viewer, t, &arr, &count) != 0) return;
+
+    if (record && recorder) {
+        record_write(recorder, t, ts_ms, arr, count);
+    }
+    install_array(ctx, tab, arr, count, ts_ms);
+
+    /* Même machine : les tâches se lisent directement dans /proc */
+    if (tab->kind == TAB_LOCAL) {
+        install_threads(tab, tab->expanded_pid > 0 ? create_thread_list(tab->expanded_pid) : NULL);
+    }
+}
+
+/* Applique les trames reçues du démon */
+static void pump_viewer(ui_context_t *ctx)
+{
+    int t, r;
+    long long ts;
+    while ((r = daemon_client_next(viewer, &t, &ts)) > 0) {
+        if (t < ctx->tab_count && ctx->tabs[t].kind != TAB_FLEET) {
+            install_from_viewer(ctx, t, ts, 1);
+        }
+    }
+    if (r < 0) {
+        /* Les onglets restent, F9 les recharge sans le démon */
+        daemon_disconnect(viewer);
+        viewer = NULL;
+        snprintf(ctx->status_msg, sizeof(ctx->status_msg),
+                 via ? "Relay connection lost: showing the last snapshots."
+                     : "Daemon stopped: showing the last snapshots.");
+    }
+}
+
+static int refresh_local(ui_context_t *ctx)
+{
+    if (!ctx || ctx->tab_count == 0 || !ctx->tabs) {
+        return -1;
+    }
+
+    machine_tab_t *tab = &ctx->tabs[0];
+
+    host_sample_t sample;
+    if (host_source_read(local_host, &sample) == 0) {
+        host_summary_update(&tab->summary, &sample);
+    }
+
+    /* Seuls les fichiers /proc utiles aux colonnes affichées sont lus */
+    unsigned needs = columns_needs(ctx->columns, 0);
+    if (ctx->group_mode == GROUP_BY_CGROUP) needs |= PROC_NEED_CGROUP;
+    process_list *list = create_process_list_needs(needs);
+    if (!list) {
+        return -1;
+    }
+
+    install_snapshot(ctx, tab, list);
+
+    /* /proc/<pid>/task n'est parcouru que pour le processus déplié */
+    install_threads(tab, tab->expanded_pid > 0 ? create_thread_list(tab->expanded_pid) : NULL);
+    return 0;
+}
+
+/* Nombre maximal de fetchs distants simultanés */
+#define MAX_INFLIGHT_FETCHES 8
+
+/* Lance les fetchs en attente, en commençant par l'onglet visible */
+static void schedule_fetches(ui_context_t *ctx,
+                             remote_inventory_t *inv,
+                             remote_fetch_t **inflight)
+{
+    int running = 0;
+    for (int t = 0; t < ctx->tab_count; ++t) {
+        if (inflight[t]) running++;
+    }
+
+    for (int k = 0; k < ctx->tab_count && running < MAX_INFLIGHT_FETCHES; ++k) {
+        int t = (ctx->current_tab_index + k) % ctx->tab_count;
+        machine_tab_t *tab = &ctx->tabs[t];
+        if (tab->kind != TAB_REMOTE || !tab->needs_fetch || inflight[t] ||
+            tab->remote_index < 0) {
+            continue;
+        }
+
+        /* Hôte en backoff : la demande reste en attente jusqu'à l'échéance */
+        remotemachine_t *m = &inv->machines[tab->remote_index];
+        if (!remote_health_due(&m->health)) {
+            continue;
+        }
+
+        tab->needs_fetch = 0;
+        remote_request_t req = { remote_query(ctx), tab->expanded_pid };
+        inflight[t] = fetch_remote_start(m, &req);
+        if (inflight[t]) {
+            running++;
+        } else {
+            tab->loaded = 1;
+        }
+    }
+}
+
+/* Récupère la sortie des fetchs en cours et installe ceux qui sont finis */
+static void pump_fetches(ui_context_t *ctx, remote_fetch_t **inflight)
+{
+    for (int t = 0; t < ctx->tab_count; ++t) {
+        if (!inflight[t]) continue;
+
+        int r = fetch_remote_poll(inflight[t]);
+        if (r == 0) continue;
+
+        /* Coût de la collecte : analyse, plus le CPU du ssh une fois attendu */
+        double cpu = sched_cpu_ms();
+        remote_result_t res;
+        int ok = -1;
+        int pending = 0;
+        if (r > 0) {
+            int probe = fetch_remote_is_probe(inflight[t]);
+            ok = fetch_remote_finish(inflight[t], &res);
+            if (probe && ctx->tabs[t].health && ctx->tabs[t].health->state == HOST_UP) {
+                /* Sonde réussie : le vrai fetch part au prochain tour */
+                ctx->tabs[t].needs_fetch = 1;
+                pending = 1;
+            }
+        } else {
+            fetch_remote_cancel(inflight[t]);
+        }
+        inflight[t] = NULL;
+
+        if (ok == 0 && res.processes) {
+            host_summary_update(&ctx->tabs[t].summary, res.host);
+            install_snapshot(ctx, &ctx->tabs[t], res.processes);
+            install_threads(&ctx->tabs[t], res.threads);
+        } else {
+            /* Échec : on garde l'ancien snapshot s'il y en a un */
+            ctx->tabs[t].loaded = 1;
+        }
+        if (ok == 0) free(res.host);
+        if (!pending) {
+            sched_collected(sched, t, now_ms(), sched_cpu_ms() - cpu);
+        }
+    }
+}
+
+static int refresh_tab(ui_context_t *ctx, int tab_index)
+{
+    if (!ctx || tab_index < 0 || tab_index >= ctx->tab_count) return -1;
+
+    machine_tab_t *tab = &ctx->tabs[tab_index];
+    if (viewer) {
+        /* Le démon collecte ; le snapshot déjà reçu est ré-installé pour
+         * appliquer tout de suite un nouveau filtre */
+        if (tab->kind != TAB_FLEET && tab->loaded) {
+            install_from_viewer(ctx, tab_index, now_ms(), 0);
+        }
+        daemon_client_request_refresh(viewer);
+        return 0;
+    }
+
+    switch (tab->kind) {
+    case TAB_LOCAL: {
+        double cpu = sched_cpu_ms();
+        int rc = refresh_local(ctx);
+        sched_collected(sched, tab_index, now_ms(), sched_cpu_ms() - cpu);
+        return rc;
+    }
+    case TAB_REMOTE:
+        /* Fetch asynchrone, lancé par schedule_fetches() */
+        tab->needs_fetch = 1;
+        sched_started(sched, tab_index);
+        return 0;
+    default:
+        /* L'onglet flotte est recalculé quand un onglet hôte change */
+        return 0;
+    }
+}
+
+/* Rafraîchit les onglets dont l'intervalle est écoulé */
+static void run_scheduled(ui_context_t *ctx, int visible)
+{
+    int t;
+    for (int n = 0; n < ctx->tab_count && (t = sched_next_due(sched, now_ms(), visible)) >= 0; ++n) {
+        refresh_tab(ctx, t);
+    }
+}
+
+/* Retourne 0 si le filtre a changé (les onglets sont à recharger) */
+static int edit_filter(ui_context_t *ctx)
+{
+    char text[128];
+    char err[64];
+    process_query_t q;
+
+    ui_prompt("Filter : ", text, sizeof(text));
+    if (process_query_parse(text, &q, err, sizeof(err)) != 0) {
+        snprintf(ctx->status_msg, sizeof(ctx->status_msg), "Invalid filter: %s", err);
+        return -1;
+    }
+
+    ctx->query = q;
+    return 0;
+}
+
+/* Installe dans chaque onglet son snapshot enregistré à la trame donnée */
+static void replay_seek(ui_context_t *ctx, const replay_t *rp, size_t frame)
+{
+    for (int t = 0; t < ctx->tab_count; ++t) {
+        if (ctx->tabs[t].kind == TAB_FLEET) continue;
+
+        process_info_t *arr;
+        int count;
+        if (replay_tab_at(rp, t, frame, &arr, &count) != 0) {
+            snprintf(ctx->status_msg, sizeof(ctx->status_msg),
+                     "Replay: corrupt frame for %s.", ctx->tabs[t].hostname);
+            continue;
+        }
+        install_array(ctx, &ctx->tabs[t], arr, count, replay_frame_time(rp, frame));
+    }
+}
+
+static void replay_status(ui_context_t *ctx, const replay_t *rp, size_t frame)
+{
+    if (ctx->status_msg[0] != '\0') return;
+
+    time_t t = (time_t)(replay_frame_time(rp, frame) / 1000);
+    struct tm tm;
+    char date[32];
+    localtime_r(&t, &tm);
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &tm);
+    snprintf(ctx->status_msg, sizeof(ctx->status_msg),
+             "REPLAY %s  frame %zu/%zu", date, frame + 1, replay_frame_count(rp));
+}
+
+/* Navigation dans un enregistrement : pas de collecte ni de signaux */
+static void run_replay(ui_context_t *ctx, const replay_t *rp)
+{
+    size_t frame = 0;
+    size_t last = replay_frame_count(rp) - 1;
+    replay_seek(ctx, rp, frame);
+
+    while (ctx->running) {
+        replay_status(ctx, rp, frame);
+        ui_draw(ctx);
+        int action = ui_input(ctx);
+        size_t target = frame;
+
+        switch (action) {
+        case KEY_F(1):
+            ui_show_help_screen(ctx);
+            break;
+        case KEY_F(4):
+            ui_search_process_by_name(ctx);
+            break;
+        case KEY_F(5):
+        case KEY_F(6):
+        case KEY_F(7):
+        case KEY_F(8):
+            snprintf(ctx->status_msg, sizeof(ctx->status_msg), "Replay: signals are disabled.");
+            break;
+        case 'f':
+            if (edit_filter(ctx) == 0) replay_seek(ctx, rp, frame);
+            break;
+        case '[':
+            if (frame > 0) target = frame - 1;
+            break;
+        case ']':
+            if (frame < last) target = frame + 1;
+            break;
+        case '{':
+            target = replay_find(rp, replay_frame_time(rp, frame) - 60000);
+            break;
+        case '}':
+            target = replay_find(rp, replay_frame_time(rp, frame) + 60000);
+            break;
+        default:
+            break;
+        }
+
+        if (target != frame) {
+            frame = target;
+            ctx->status_msg[0] = '\0';
+            replay_seek(ctx, rp, frame);
+        }
+    }
+}
+
+static void jump_to_host(ui_context_t *ctx, const remote_inventory_t *inv)
+{
+    char name[64];
+    if (ui_prompt("Host : ", name, sizeof(name)) == 0) {
+        return;
+    }
+
+    int idx = remote_inventory_find(inv, name);
+    for (int t = 0; idx >= 0 && t < ctx->tab_count; ++t) {
+        if (ctx->tabs[t].kind == TAB_REMOTE && ctx->tabs[t].remote_index == idx) {
+            ctx->current_tab_index = t;
+            ctx->scroll_offset = 0;
+            return;
+        }
+    }
+
+    for (int t = 0; t < ctx->tab_count; ++t) {
+        if (strcmp(name, ctx->tabs[t].hostname) == 0) {
+            ctx->current_tab_index = t;
+            ctx->scroll_offset = 0;
+            return;
+        }
+    }
+    snprintf(ctx->status_msg, sizeof(ctx->status_msg), "Unknown host \"%s\".", name);
+}
+
+/* Retourne l'onglet visé quand le signal est déjà parti (local), -1
+ * sinon : un signal distant est mis en file et l'onglet sera rafraîchi
+ * à la fin de son lot. */
+static int send_signal_selected(ui_context_t *ctx, int signum, const remote_inventory_t *inv)
+{
+    if (!ctx || ctx->tab_count == 0 || !ctx->tabs) {
+        return -1;
+    }
+
+    int idx = ui_selected_index(ctx);
+    if (idx < 0) {
+        return -1;
+    }
+
+    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
+    int pid = tab->processes[idx].pid;
+    int target = ctx->current_tab_index;
+
+    /* Onglet "All hosts" : on vise l'hôte d'origine de la ligne */
+    if (tab->kind == TAB_FLEET) {
+        if (!tab->origin) return -1;
+        target = tab->origin[idx];
+    }
+
+    if (pid <= 0) {
+        return -1;
+    }
+
+    if (ctx->tabs[target].kind == TAB_LOCAL) {
+        /* Local -> kill() immédiat, résultat affiché comme les autres */
+        action_queue_signal(actions, target, -1, pid, signum);
+        return target;
+    }
+
+    int host = ctx->tabs[target].remote_index;
+    if ((host < 0 || (size_t)host >= inv->count) && viewer) {
+        /* Hôte connu du démon ou du relais seulement : il envoie le signal,
+         * le snapshot suivant montre le résultat */
+        if (daemon_client_send_signal(viewer, target, pid, signum) == 0) {
+            snprintf(ctx->status_msg, sizeof(ctx->status_msg), "%s %d sent to %s.",
+                     transport_signal_name(signum), pid, via ? via : "the daemon");
+        }
+        return -1;
+    }
+    if (host < 0 || (size_t)host >= inv->count) {
+        /* Onglet reçu du démon pour un hôte absent de notre configuration */
+        snprintf(ctx->status_msg, sizeof(ctx->status_msg),
+                 "%s is not in this instance's remote config.", ctx->tabs[target].hostname);
+        return -1;
+    }
+
+    /* Distant -> file d'actions, envoyée sans bloquer l'UI */
+    action_queue_signal(actions, target, host, pid, signum);
+    return -1;
+}
+
+/* Lots d'actions terminés : leurs onglets sont rafraîchis */
+static void pump_actions(ui_context_t *ctx, remote_inventory_t *inv)
+{
+    int done[16];
+    int n = action_queue_pump(actions, inv, done, 16);
+    for (int i = 0; i < n; ++i) {
+        if (done[i] >= 0 && done[i] < ctx->tab_count) refresh_tab(ctx, done[i]);
+    }
+}
+
+/* --batch : un snapshot filtré de chaque hôte, écrit sur stdout */
+static int batch_export(const ui_context_t *ctx, remote_inventory_t *inv, int include_all)
+{
+    size_t hosts = include_all ? inv->count : 0;
+    char line[1024];
+
+    columns_format_header(ctx->columns, line, sizeof(line));
+    printf("%s%s\n", hosts > 0 ? "HOST         " : "", line);
+
+    for (size_t h = 0; h <= hosts; ++h) {
+        process_list *list;
+        const char *name = "local";
+        if (h == 0) {
+            list = create_process_list_needs(columns_needs(ctx->columns, 0));
+        } else {
+            remotemachine_t *m = &inv->machines[h - 1];
+            name = m->name[0] != '\0' ? m->name : m->host;
+            list = fetch_remote_processes(m, &ctx->query);
+        }
+        if (!list) {
+            fprintf(stderr, "%s: unable to list processes\n", name);
+            continue;
+        }
+
+        process_info_t *arr = NULL;
+        int count = list_to_array(list, &arr);
+        free_process_list(list);
+        /* Un seul snapshot : sort=pss lit smaps_rollup de chaque processus */
+        if (h == 0 && ctx->query.sort == PROC_SORT_PSS) {
+            for (int i = 0; i < count; ++i) process_fill_extra(&arr[i], PROC_NEED_SMAPS);
+        }
+        count = process_array_apply_query(arr, count, &ctx->query);
+
+        /* Colonnes coûteuses : seulement pour les lignes retenues */
+        unsigned extra = h == 0 ? columns_needs(ctx->columns, 1) : 0;
+        for (int i = 0; i < count; ++i) {
+            if (extra) process_fill_extra(&arr[i], extra);
+            columns_format_row(ctx->columns, &arr[i], line, sizeof(line));
+            if (hosts > 0) printf("%-12.12s %s\n", name, line);
+            else           printf("%s\n", line);
+        }
+        free(arr);
+    }
+    return 0;
+}
+
+/* Onglets de la collecte : la machine locale, les distants si demandé
+ * et l'onglet "All hosts" quand il y en a */
+static int setup_tabs(ui_context_t *ctx, const remote_inventory_t *inv, int include_all)
+{
+    size_t remote_count = inv->count;
+    int with_fleet = include_all && remote_count > 0;
+    int max_tabs = 1 + (include_all ? (int)remote_count : 0) + with_fleet;
+    ctx->tabs = calloc((size_t)max_tabs, sizeof(machine_tab_t));
+    if (!ctx->tabs) {
+        perror("malloc tabs");
+        return -1;
+    }
+
+    ctx->tab_count = 1;
+    ctx->current_tab_index = 0;
+    ctx->running = 1;
+    ctx->scroll_offset = 0;
+
+    machine_tab_t *local_tab = &ctx->tabs[0];
+    snprintf(local_tab->hostname, sizeof(local_tab->hostname), "Local");
+    local_tab->kind = TAB_LOCAL;
+    local_tab->remote_index = -1;
+    local_tab->processes = NULL;
+    local_tab->process_count = 0;
+    local_tab->selected_proc_index = 0;
+
+    /* Onglets distants si demandé : ils sont remplis en arrière-plan
+     * une fois l'UI affichée, l'onglet visible en premier */
+    if (include_all && remote_count > 0) {
+        for (size_t i = 0; i < remote_count; ++i) {
+            machine_tab_t *tab = &ctx->tabs[ctx->tab_count];
+            const remotemachine_t *m = &inv->machines[i];
+            tab->kind = TAB_REMOTE;
+            tab->remote_index = (int)i;
+            tab->health = &m->health;
+
+            if (m->name[0] != '\0')
+                snprintf(tab->hostname, sizeof(tab->hostname), "%s", m->name);
+            else
+                snprintf(tab->hostname, sizeof(tab->hostname), "%s", m->host);
+
+            tab->processes = NULL;
+            tab->process_count = 0;
+            tab->selected_proc_index = 0;
+
+            tab->needs_fetch = 1;
+
+            ctx->tab_count++;
+        }
+    }
+
+    if (with_fleet) {
+        machine_tab_t *fleet = &ctx->tabs[ctx->tab_count];
+        snprintf(fleet->hostname, sizeof(fleet->hostname), "All hosts");
+        fleet->kind = TAB_FLEET;
+        fleet->remote_index = -1;
+        ctx->fleet_tab_index = ctx->tab_count;
+        ctx->tab_count++;
+
+        for (int t = 0; t < ctx->fleet_tab_index; ++t) {
+            fleet_rank_tab(&ctx->tabs[t], ctx->fleet_k);
+        }
+        fleet_merge(ctx);
+    }
+    return 0;
+}
+
+/* Onglets décrits par le démon ; les distants gardent leur index dans
+ * notre configuration (signaux), -1 s'ils n'y sont pas. Derrière un
+ * relais, l'onglet local est celui du bastion. */
+static int setup_viewer_tabs(ui_context_t *ctx, const remote_inventory_t *inv)
+{
+    int n;
+    const record_tab_t *rt = daemon_client_tabs(viewer, &n);
+    ctx->tabs = calloc((size_t)n, sizeof(machine_tab_t));
+    if (!ctx->tabs) {
+        perror("malloc tabs");
+        return -1;
+    }
+    ctx->tab_count = n;
+    ctx->current_tab_index = 0;
+    ctx->running = 1;
+
+    for (int t = 0; t < n; ++t) {
+        machine_tab_t *tab = &ctx->tabs[t];
+        snprintf(tab->hostname, sizeof(tab->hostname), "%s", rt[t].name);
+        tab->remote_index = -1;
+        if (rt[t].kind == RECORD_TAB_FLEET) {
+            tab->kind = TAB_FLEET;
+            ctx->fleet_tab_index = t;
+        } else if (t == 0 && !via) {
+            tab->kind = TAB_LOCAL;
+        } else if (t == 0) {
+            tab->kind = TAB_REMOTE;
+            snprintf(tab->hostname, sizeof(tab->hostname), "%s", via);
+        } else {
+            tab->kind = TAB_REMOTE;
+            tab->remote_index = remote_inventory_find(inv, rt[t].name);
+            if (tab->remote_index >= 0) tab->health = &inv->machines[tab->remote_index].health;
+        }
+    }
+    return 0;
+}
+
+/* Session interactive : collecte directe, ou snapshots reçus du démon */
+static void run_live(ui_context_t *ctx, remote_inventory_t *inv, remote_fetch_t **inflight)
+{
+    while (ctx->running) {
+        if (viewer) pump_viewer(ctx);
+
+        /* L'onglet affiché au rythme de base ; "All hosts" les montre tous */
+        int visible = ctx->current_tab_index == ctx->fleet_tab_index ? SCHED_ALL_VISIBLE
+                                                                     : ctx->current_tab_index;
+        run_scheduled(ctx, visible);
+        schedule_fetches(ctx, inv, inflight);
+        pump_fetches(ctx, inflight);
+        pump_actions(ctx, inv);
+        smaps_cache_refresh(smaps, SMAPS_TICK_BUDGET_MS);
+
+        ui_draw(ctx);
+        int action = ui_input(ctx);
+
+        switch (action) {
+        case KEY_F(1):
+            ui_show_help_screen(ctx);
+            break;
+        case KEY_F(4):
+            ui_search_process_by_name(ctx);
+            break;
+        case KEY_F(5):
+        case KEY_F(6):
+        case KEY_F(7):
+        case KEY_F(8): {
+            int signum = (action == KEY_F(5)) ? SIGSTOP :
+                         (action == KEY_F(6)) ? SIGTERM :
+                         (action == KEY_F(7)) ? SIGKILL : SIGCONT;
+            /* Rafraichissement intelligent : on refresh l'onglet de la cible
+             * (distant : à la fin du lot, par pump_actions) */
+            int target = send_signal_selected(ctx, signum, inv);
+            if (target >= 0) refresh_tab(ctx, target);
+            break;
+        }
+        case KEY_F(9):
+            /* Refresh local et remotes */
+            for (int t = 0; t < ctx->tab_count; ++t) {
+                refresh_tab(ctx, t);
+            }
+            break;
+        case 'j':
+            jump_to_host(ctx, inv);
+            break;
+        case 'f':
+            if (edit_filter(ctx) == 0) {
+                for (int t = 0; t < ctx->tab_count; ++t) {
+                    refresh_tab(ctx, t);
+                }
+            }
+            break;
+        case 't':
+            refresh_tab(ctx, ctx->current_tab_index);
+            break;
+        case 'g':
+            refresh_tab(ctx, 0);
+            break;
+        default:
+            break;
+        }
+    }
+
+}
+
+static volatile sig_atomic_t daemon_stop;
+
+static void on_daemon_signal(int sig)
+{
+    (void)sig;
+    daemon_stop = 1;
+}
+
+/* Signaux demandés par les lecteurs, envoyés depuis cette machine */
+static void take_viewer_signals(ui_context_t *ctx, remote_inventory_t *inv)
+{
+    int t, pid, signum;
+    while (daemon_take_signal(server, &t, &pid, &signum)) {
+        machine_tab_t *tab = &ctx->tabs[t];
+        int host = tab->kind == TAB_LOCAL ? -1 : tab->remote_index;
+        if (tab->kind == TAB_FLEET || (tab->kind == TAB_REMOTE && (host < 0 || (size_t)host >= inv->count))) {
+            continue;
+        }
+        if (action_queue_signal(actions, t, host, pid, signum) < 0) continue;
+        fprintf(stderr, "%s: %s %d requested by a viewer.\n",
+                tab->hostname, transport_signal_name(signum), pid);
+        /* Local : déjà envoyé ; distant : rafraîchi à la fin du lot */
+        if (host < 0) refresh_tab(ctx, t);
+    }
+}
+
+/* --daemon : collecte périodique sans interface, diffusée aux lecteurs.
+ * relay : un seul lecteur sur stdin / stdout, on s'arrête quand il part. */
+static void run_daemon(ui_context_t *ctx, remote_inventory_t *inv, remote_fetch_t **inflight,
+                       int relay)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_daemon_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    fprintf(stderr, "%s: %d tab(s), every %d ms or more.\n",
+            relay ? "Relay" : "Collector daemon", ctx->tab_count, sched_interval(sched, 0));
+
+    while (!daemon_stop && !(relay && daemon_viewer_count(server) == 0)) {
+        /* Les lecteurs peuvent regarder n'importe quel onglet */
+        run_scheduled(ctx, SCHED_ALL_VISIBLE);
+        schedule_fetches(ctx, inv, inflight);
+        pump_fetches(ctx, inflight);
+        take_viewer_signals(ctx, inv);
+        pump_actions(ctx, inv);
+
+        /* Alertes des règles (--rules) : pas d'UI, sur stderr */
+        if (ctx->status_msg[0] != '\0') {
+            fprintf(stderr, "%s\n", ctx->status_msg);
+            ctx->status_msg[0] = '\0';
+        }
+
+        if (daemon_poll(server, UI_TICK_MS)) {
+            sched_request(sched);
+        }
+    }
+}
+
+/* Description des onglets pour l'entête (enregistrement, démon) */
+static record_tab_t *describe_tabs(const ui_context_t *ctx)
+{
+    record_tab_t *rt = calloc((size_t)ctx->tab_count, sizeof(record_tab_t));
+    for (int t = 0; rt && t < ctx->tab_count; ++t) {
+        snprintf(rt[t].name, sizeof(rt[t].name), "%s", ctx->tabs[t].hostname);
+        rt[t].kind = ctx->tabs[t].kind == TAB_FLEET ? RECORD_TAB_FLEET : RECORD_TAB_HOST;
+    }
+    return rt;
+}
+
+/* Ajoute arg entre apostrophes pour le shell distant */
+static void append_quoted(char *buf, size_t size, const char *arg)
+{
+    size_t off = strlen(buf);
+    if (off + 3 >= size) return;
+    buf[off++] = ' ';
+    buf[off++] = '\'';
+    for (const char *p = arg; *p && off + 6 < size; ++p) {
+        if (*p == '\'') {
+            memcpy(buf + off, "'\\''", 4);
+            off += 4;
+        } else {
+            buf[off++] = *p;
+        }
+    }
+    buf[off++] = '\'';
+    buf[off] = '\0';
+}
+
+/* Lance "command --relay ..." sur le bastion "[user@]host[:port]" et lit
+ * son flux comme celui d'un démon */
+static daemon_client_t *connect_relay(const char *spec, const char *command)
+{
+    remotemachine_t m;
+    memset(&m, 0, sizeof(m));
+    m.port = 22;
+
+    const char *host = spec;
+    const char *at = strchr(spec, '@');
+    if (at) {
+        snprintf(m.username, sizeof(m.username), "%.*s", (int)(at - spec), spec);
+        host = at + 1;
+    }
+    snprintf(m.host, sizeof(m.host), "%s", host);
+    char *colon = strchr(m.host, ':');
+    if (colon) {
+        *colon = '\0';
+        m.port = atoi(colon + 1);
+        if (m.port <= 0) m.port = 22;
+    }
+
+    int fd;
+    pid_t pid = transport_open_stream(&m, command, &fd);
+    if (pid < 0) return NULL;
+
+    /* Connexion ssh, puis l'entête envoyé dès le démarrage du relais */
+    return daemon_attach(fd, pid, spec, (NET_CONNECT_TIMEOUT + 10) * 1000);
+}
+
+static struct option long_options[] = {
+    {"help",          no_argument,       0, 'h'},
+    {"dry-run",       no_argument,       0,  1 },
+    {"remote-config", required_argument, 0, 'c'},
+    {"remote-server", required_argument, 0, 's'},
+    {"username",      required_argument, 0, 'u'},
+    {"password",      required_argument, 0, 'p'},
+    {"all",           no_argument,       0, 'a'},
+    {"top-k",         required_argument, 0, 'k'},
+    {"filter",        required_argument, 0, 'f'},
+    {"columns",       required_argument, 0, 'C'},
+    {"record",        required_argument, 0,  2 },
+    {"replay",        required_argument, 0,  3 },
+    {"rules",         required_argument, 0,  4 },
+    {"batch",         no_argument,       0,  5 },
+    {"daemon",        no_argument,       0,  6 },
+    {"socket",        required_argument, 0,  7 },
+    {"no-daemon",     no_argument,       0,  8 },
+    {"shm",           optional_argument, 0,  9 },
+    {"interval",      required_argument, 0, 10 },
+    {"budget",        required_argument, 0, 11 },
+    {"relay",         no_argument,       0, 12 },
+    {"via",           required_argument, 0, 13 },
+    {"relay-command", required_argument, 0, 14 },
+    {0, 0, 0, 0}
+};
+
+int main(int argc, char **argv)
+{
+    ui_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.fleet_tab_index = -1;
+    ctx.fleet_key = PROC_SORT_CPU;
+    ctx.fleet_k = FLEET_DEFAULT_K;
+    ctx.columns = COLUMNS_DEFAULT;
+
+    remote_inventory_t inventory;
+    memset(&inventory, 0, sizeof(inventory));
+    remote_fetch_t **inflight = NULL;
+
+    char *conf_path  = NULL;
+    char *cli_server = NULL;
+    char *cli_user   = NULL;
+    char *cli_pass   = NULL;
+    int include_all  = 0;
+    int dry_run      = 0;
+    int batch        = 0;
+    int daemon_mode  = 0;
+    int no_daemon    = 0;
+    int relay_mode   = 0;
+    const char *relay_cmd = RELAY_DEFAULT_COMMAND;
+    const char *filter_text = NULL;
+    char socket_path[108];
+    daemon_socket_path(socket_path, sizeof(socket_path));
+    char shm_name[64] = "";
+    int interval_ms  = SCHED_DEFAULT_INTERVAL_MS;
+    double budget    = SCHED_DEFAULT_BUDGET;
+    char *record_path = NULL;
+    char *replay_path = NULL;
+
+    char err[64];
+    int opt, opt_index = 0;
+    while ((opt = getopt_long(argc, argv, "hc:s:u:p:ak:f:C:", long_options, &opt_index)) != -1) {
+        switch (opt) {
+        case 'h':
+            print_help(argv[0]);
+            return EXIT_SUCCESS;
+        case 1:
+            dry_run = 1;
+            break;
+        case 2:
+            record_path = optarg;
+            break;
+        case 3:
+            replay_path = optarg;
+            break;
+        case 4:
+            rules_free(rules);
+            rules = rules_load(optarg);
+            if (!rules) return EXIT_FAILURE;
+            break;
+        case 5:
+            batch = 1;
+            break;
+        case 6:
+            daemon_mode = 1;
+            break;
+        case 7:
+            snprintf(socket_path, sizeof(socket_path), "%s", optarg);
+            break;
+        case 8:
+            no_daemon = 1;
+            break;
+        case 9:
+            if (optarg) snprintf(shm_name, sizeof(shm_name), "%s", optarg);
+            else        shm_default_name(shm_name, sizeof(shm_name));
+            break;
+        case 10:
+            interval_ms = atoi(optarg);
+            if (interval_ms < 0) interval_ms = 0;
+            break;
+        case 11:
+            budget = atof(optarg);
+            break;
+        case 12:
+            relay_mode = 1;
+            break;
+        case 13:
+            via = optarg;
+            break;
+        case 14:
+            relay_cmd = optarg;
+            break;
+        case 'c':
+            conf_path = optarg;
+            break;
+        case 's':
+            cli_server = optarg;
+            break;
+        case 'u':
+            cli_user = optarg;
+            break;
+        case 'p':
+            cli_pass = optarg;
+            break;
+        case 'a':
+            include_all = 1;
+            break;
+        case 'f':
+            if (process_query_parse(optarg, &ctx.query, err, sizeof(err)) != 0) {
+                fprintf(stderr, "Invalid filter \"%s\": %s\n", optarg, err);
+                return EXIT_FAILURE;
+            }
+            filter_text = optarg;
+            break;
+        case 'C':
+            if (columns_parse(optarg, &ctx.columns) != 0) {
+                fprintf(stderr, "Invalid column list: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'k':
+            ctx.fleet_k = atoi(optarg);
+            if (ctx.fleet_k <= 0) ctx.fleet_k = FLEET_DEFAULT_K;
+            break;
+        default:
+            print_help(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (dry_run) {
+        process_list *list = create_process_list();
+        if (!list) {
+            fprintf(stderr, "Failed to get process list.\n");
+            return EXIT_FAILURE;
+        }
+        free_process_list(list);
+        printf("Local process listing: OK\n");
+        return EXIT_SUCCESS;
+    }
+
+    if (replay_path) {
+        replay_t *rp = replay_open(replay_path);
+        if (!rp) return EXIT_FAILURE;
+        if (replay_frame_count(rp) == 0) {
+            fprintf(stderr, "%s: empty recording\n", replay_path);
+            replay_close(rp);
+            return EXIT_FAILURE;
+        }
+
+        /* Onglets de l'enregistrement ; les hôtes sont de type distant pour
+         * que rien ne soit lu ni envoyé à la machine locale */
+        ctx.tab_count = replay_tab_count(rp);
+        ctx.tabs = calloc((size_t)ctx.tab_count, sizeof(machine_tab_t));
+        if (!ctx.tabs) {
+            perror("malloc tabs");
+            replay_close(rp);
+            return EXIT_FAILURE;
+        }
+        for (int t = 0; t < ctx.tab_count; ++t) {
+            const record_tab_t *rt = replay_tab(rp, t);
+            machine_tab_t *tab = &ctx.tabs[t];
+            snprintf(tab->hostname, sizeof(tab->hostname), "%s", rt->name);
+            tab->remote_index = -1;
+            tab->loaded = 1;
+            tab->kind = TAB_REMOTE;
+            if (rt->kind == RECORD_TAB_FLEET) {
+                tab->kind = TAB_FLEET;
+                ctx.fleet_tab_index = t;
+            }
+        }
+        ctx.running = 1;
+
+        /* Les alertes sont rejouées, pas les commandes associées */
+        rules_set_exec(rules, 0);
+
+        ui_init();
+        run_replay(&ctx, rp);
+        ui_clean();
+
+        for (int i = 0; i < ctx.tab_count; ++i) {
+            free(ctx.tabs[i].processes);
+            group_table_free(ctx.tabs[i].groups);
+            fleet_free_tab(&ctx.tabs[i]);
+            hot_columns_free(&ctx.tabs[i].hot);
+        }
+        free(ctx.tabs);
+        replay_close(rp);
+        rules_free(rules);
+        return EXIT_SUCCESS;
+    }
+
+    /* Derrière un relais, -c désigne la configuration du bastion */
+    if (conf_path && !via) {
+        load_remote_config(conf_path, &inventory);
+    }
+    if (relay_mode) {
+        include_all = 1;
+    }
+
+    if (cli_server) {
+        add_remote_machine(&inventory,
+                           cli_server, cli_server, 22,
+                           cli_user, cli_pass, "ssh");
+    }
+
+    if (batch) {
+        batch_export(&ctx, &inventory, include_all);
+        remote_inventory_free(&inventory);
+        return EXIT_SUCCESS;
+    }
+
+    if (via) {
+        char cmd[1024];
+        snprintf(cmd, sizeof(cmd), "%s --relay --interval %d --budget %g",
+                 relay_cmd, interval_ms, budget);
+        if (conf_path) {
+            strncat(cmd, " -c", sizeof(cmd) - strlen(cmd) - 1);
+            append_quoted(cmd, sizeof(cmd), conf_path);
+        }
+        /* Avec des règles, le relais envoie les snapshots complets */
+        if (filter_text && !rules) {
+            strncat(cmd, " -f", sizeof(cmd) - strlen(cmd) - 1);
+            append_quoted(cmd, sizeof(cmd), filter_text);
+        }
+        viewer = connect_relay(via, cmd);
+        if (!viewer) {
+            fprintf(stderr, "Unable to reach the relay on %s.\n", via);
+            remote_inventory_free(&inventory);
+            return EXIT_FAILURE;
+        }
+    } else if (!daemon_mode && !relay_mode && !no_daemon && shm_name[0] == '\0') {
+        /* Une instance qui publie en mémoire partagée collecte elle-même */
+        viewer = daemon_connect(socket_path);
+    }
+    int rc = viewer ? setup_viewer_tabs(&ctx, &inventory)
+                    : setup_tabs(&ctx, &inventory, include_all);
+    inflight = calloc((size_t)(ctx.tab_count > 0 ? ctx.tab_count : 1), sizeof(remote_fetch_t *));
+    if (rc != 0 || !inflight) {
+        free(ctx.tabs);
+        free(inflight);
+        daemon_disconnect(viewer);
+        remote_inventory_free(&inventory);
+        return EXIT_FAILURE;
+    }
+
+    /* L'entête de l'enregistrement décrit les onglets : ouvert une fois
+     * ceux-ci créés, avant le premier snapshot */
+    record_tab_t *rt = describe_tabs(&ctx);
+    if (record_path) {
+        recorder = rt ? record_open(record_path, rt, ctx.tab_count) : NULL;
+        if (!recorder) {
+            fprintf(stderr, "Unable to record to %s.\n", record_path);
+            rc = -1;
+        }
+    }
+    if (rc == 0 && (daemon_mode || relay_mode)) {
+        server = !rt ? NULL : relay_mode ? daemon_serve_stdio(rt, ctx.tab_count)
+                                         : daemon_listen(socket_path, rt, ctx.tab_count);
+        if (!server) rc = -1;
+    }
+    free(rt);
+    if (rc == 0 && shm_name[0] != '\0') {
+        publisher = shm_publish_open(shm_name, NULL);
+        if (!publisher) rc = -1;
+    }
+
+    /* Le démon collecte en continu, même avec --interval 0 */
+    if (rc == 0 && !viewer) {
+        local_host = host_source_open();
+        if (server && interval_ms == 0) interval_ms = SCHED_DEFAULT_INTERVAL_MS;
+        sched = sched_new(ctx.tab_count, interval_ms, budget);
+        for (int t = 0; sched && t < ctx.tab_count; ++t) {
+            if (ctx.tabs[t].kind == TAB_FLEET) sched_disable(sched, t);
+            if (ctx.tabs[t].needs_fetch) sched_started(sched, t);
+        }
+    }
+
+    /* Avec un démon, les snapshots arrivent par la socket */
+    if (rc == 0 && !viewer && refresh_tab(&ctx, 0) != 0) {
+        fprintf(stderr, "Unable to get local process list.\n");
+        rc = -1;
+    }
+    if (rc != 0) {
+        record_close(recorder);
+        sched_free(sched);
+        host_source_close(local_host);
+        shm_publish_close(publisher);
+        daemon_close(server);
+        daemon_disconnect(viewer);
+        free(ctx.tabs);
+        free(inflight);
+        remote_inventory_free(&inventory);
+        return EXIT_FAILURE;
+    }
+
+    /* Le démon envoie aussi les signaux demandés par ses lecteurs */
+    actions = action_queue_new();
+    ctx.actions = actions;
+    if (server) {
+        run_daemon(&ctx, &inventory, inflight, relay_mode);
+    } else {
+        if (via) {
+            snprintf(ctx.status_msg, sizeof(ctx.status_msg),
+                     "Connected to the relay on %.60s.", via);
+        } else if (viewer) {
+            snprintf(ctx.status_msg, sizeof(ctx.status_msg),
+                     "Connected to the collector daemon (%.60s).", socket_path);
+        }
+        smaps = smaps_cache_new();
+        ctx.smaps = smaps;
+        ui_init();
+        run_live(&ctx, &inventory, inflight);
+        ui_clean();
+        smaps_cache_free(smaps);
+    }
+    action_queue_free(actions);
+
+    if (ctx.tabs) {
+        for (int i = 0; i < ctx.tab_count; ++i) {
+            fetch_remote_cancel(inflight[i]);
+            free(ctx.tabs[i].processes);
+            group_table_free(ctx.tabs[i].groups);
+            fleet_free_tab(&ctx.tabs[i]);
+            hot_columns_free(&ctx.tabs[i].hot);
+            free_thread_list(ctx.tabs[i].threads);
+        }
+        free(ctx.tabs);
+    }
+    free(inflight);
+    remote_inventory_free(&inventory);
+    record_close(recorder);
+    sched_free(sched);
+    host_source_close(local_host);
+    shm_publish_close(publisher);
+    daemon_close(server);
+    daemon_disconnect(viewer);
+    rules_free(rules);
+    cgroup_cleanup();
+
+    return EXIT_SUCCESS;
+}
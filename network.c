@@ -1,155 +1,513 @@
-#define _POSIX_C_SOURCE 200809L
-#include "network.h"
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <errno.h>
-#include <signal.h>
-
-static int ensure_capacity(remotemachine_t **machines, size_t *cap, size_t needed)
-{
-    if (needed <= *cap) return 0;
-    size_t newcap = (*cap == 0) ? 4 : *cap * 2;
-    while (newcap < needed) newcap *= 2;
-
-    remotemachine_t *tmp = realloc(*machines, newcap * sizeof(remotemachine_t));
-    if (!tmp) return -1;
-
-    *machines = tmp;
-    *cap = newcap;
-    return 0;
-}
-
-int add_remote_machine(remotemachine_t **machines,
-                       size_t *count,
-                       const char *name,
-                       const char *host,
-                       int port,
-                       const char *username,
-                       const char *password,
-                       const char *type)
-{
-    static size_t cap = 0;
-    if (ensure_capacity(machines, &cap, *count + 1) != 0) {
-        perror("realloc");
-        return -1;
-    }
-
-    remotemachine_t *m = &(*machines)[*count];
-    memset(m, 0, sizeof(*m));
-
-    if (name)     strncpy(m->name, name, sizeof(m->name) - 1);
-    if (host)     strncpy(m->host, host, sizeof(m->host) - 1);
-    m->port = port > 0 ? port : 22;
-    if (username) strncpy(m->username, username, sizeof(m->username) - 1);
-    if (password) strncpy(m->password, password, sizeof(m->password) - 1);
-    if (type)     strncpy(m->type, type, sizeof(m->type) - 1);
-    else          strncpy(m->type, "ssh", sizeof(m->type) - 1);
-
-    (*count)++;
-    return 0;
-}
-
-int load_remote_config(const char *path,
-                       remotemachine_t **machines,
-                       size_t *count)
-{
-    FILE *f = fopen(path, "r");
-    if (!f) {
-        perror("fopen remote-config");
-        return -1;
-    }
-
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t n;
-
-    while ((n = getline(&line, &len, f)) != -1) {
-        if (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r'))
-            line[n - 1] = '\0';
-
-        if (line[0] == '\0' || line[0] == '#')
-            continue;
-
-        /* nom:adresse:port:user:pass:type */
-        char *saveptr = NULL;
-        char *name     = strtok_r(line, ":", &saveptr);
-        char *addr     = strtok_r(NULL, ":", &saveptr);
-        char *port_str = strtok_r(NULL, ":", &saveptr);
-        char *user     = strtok_r(NULL, ":", &saveptr);
-        char *pass     = strtok_r(NULL, ":", &saveptr);
-        char *type     = strtok_r(NULL, ":", &saveptr);
-
-        if (!name || !addr || !port_str || !user || !pass || !type)
-            continue;
-
-        int port = atoi(port_str);
-        add_remote_machine(machines, count, name, addr, port, user, pass, type);
-    }
-
-    free(line);
-    fclose(f);
-    return 0;
-}
-
-process_list *fetch_remote_processes(const remotemachine_t *m)
-{
-    char cmd[512];
-
-    if (m->type[0] != '\0' && strcmp(m->type, "ssh") != 0) {
-        fprintf(stderr, "Unsupported remote type: %s\n", m->type);
-        return NULL;
-    }
-
-    if (m->username[0] != '\0') {
-        snprintf(cmd, sizeof(cmd),
-                 "ssh -p %d %s@%s \"ps -eo pid,user,pcpu,pmem,stat,comm\" 2>/dev/null",
-                 m->port, m->username, m->host);
-    } else {
-        snprintf(cmd, sizeof(cmd),
-                 "ssh -p %d %s \"ps -eo pid,user,pcpu,pmem,stat,comm\" 2>/dev/null",
-                 m->port, m->host);
-    }
-
-    FILE *fp = popen(cmd, "r");
-    if (!fp) {
-        perror("popen ssh");
-        return NULL;
-    }
-
-    process_list *list = create_process_list_from_stream(fp);
-    pclose(fp);
-
-    return list;
-}
-
-int send_remote_signal(const remotemachine_t *m, int pid, int signum)
-{
-    char sig_str[10];
-    
-    /* On convertit le signal entier en chaîne pour la commande kill */
-    switch (signum) {
-        case SIGSTOP: strcpy(sig_str, "-STOP"); break;
-        case SIGTERM: strcpy(sig_str, "-TERM"); break;
-        case SIGKILL: strcpy(sig_str, "-KILL"); break;
-        case SIGCONT: strcpy(sig_str, "-CONT"); break;
-        default: return -1; /* Signal non supporté */
-    }
-
-    char cmd[512];
-    
-    /* Construction de la commande SSH : ssh user@host "kill -SIG PID" */
-    if (m->username[0] != '\0') {
-        snprintf(cmd, sizeof(cmd),
-                 "ssh -p %d %s@%s \"kill %s %d\" >/dev/null 2>&1",
-                 m->port, m->username, m->host, sig_str, pid);
-    } else {
-        snprintf(cmd, sizeof(cmd),
-                 "ssh -p %d %s \"kill %s %d\" >/dev/null 2>&1",
-                 m->port, m->host, sig_str, pid);
-    }
-
-    /* system() exécute la commande et retourne son code de sortie */
-    return system(cmd);
-}
\ No newline at end of file
+#define _POSIX_C_SOURCE 200809L
+#include "network.h"
+#include "transport.h"
+#include "clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+static int ensure_capacity(remotemachine_t **machines, size_t *cap, size_t needed)
+{
+    if (needed <= *cap) return 0;
+    size_t newcap = (*cap == 0) ? 4 : *cap * 2;
+    while (newcap < needed) newcap *= 2;
+
+    remotemachine_t *tmp = realloc(*machines, newcap * sizeof(remotemachine_t));
+    if (!tmp) return -1;
+
+    *machines = tmp;
+    *cap = newcap;
+    return 0;
+}
+
+static unsigned long hash_name(const char *s)
+{
+    /* FNV-1a */
+    unsigned long h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static const char *machine_key(const remotemachine_t *m)
+{
+    return m->name[0] != '\0' ? m->name : m->host;
+}
+
+static void index_insert(remote_inventory_t *inv, size_t idx)
+{
+    size_t mask = inv->slot_cap - 1;
+    size_t h = hash_name(machine_key(&inv->machines[idx])) & mask;
+    while (inv->name_slots[h] != -1) h = (h + 1) & mask;
+    inv->name_slots[h] = (int)idx;
+}
+
+static int index_grow(remote_inventory_t *inv, size_t needed)
+{
+    if (needed * 2 <= inv->slot_cap) return 0;
+
+    size_t newcap = inv->slot_cap ? inv->slot_cap * 2 : 64;
+    while (needed * 2 > newcap) newcap *= 2;
+
+    int *slots = malloc(newcap * sizeof(int));
+    if (!slots) return -1;
+    for (size_t i = 0; i < newcap; ++i) slots[i] = -1;
+
+    free(inv->name_slots);
+    inv->name_slots = slots;
+    inv->slot_cap = newcap;
+    for (size_t i = 0; i < inv->count; ++i) {
+        index_insert(inv, i);
+    }
+    return 0;
+}
+
+int add_remote_machine(remote_inventory_t *inv,
+                       const char *name,
+                       const char *host,
+                       int port,
+                       const char *username,
+                       const char *password,
+                       const char *type)
+{
+    if (ensure_capacity(&inv->machines, &inv->cap, inv->count + 1) != 0 ||
+        index_grow(inv, inv->count + 1) != 0) {
+        perror("realloc");
+        return -1;
+    }
+
+    remotemachine_t *m = &inv->machines[inv->count];
+    memset(m, 0, sizeof(*m));
+
+    if (name)     strncpy(m->name, name, sizeof(m->name) - 1);
+    if (host)     strncpy(m->host, host, sizeof(m->host) - 1);
+    m->port = port > 0 ? port : 22;
+    if (username) strncpy(m->username, username, sizeof(m->username) - 1);
+    if (password) strncpy(m->password, password, sizeof(m->password) - 1);
+    if (type)     strncpy(m->type, type, sizeof(m->type) - 1);
+    else          strncpy(m->type, "ssh", sizeof(m->type) - 1);
+
+    /* Type inconnu ou paramètres invalides : la machine est ignorée */
+    const transport_t *t = transport_find(m->type);
+    if (!t) {
+        fprintf(stderr, "%s: unsupported remote type '%s'\n", m->name, m->type);
+        return -1;
+    }
+    if (t->open && t->open(m) != 0) {
+        return -1;
+    }
+
+    index_insert(inv, inv->count);
+    inv->count++;
+    return 0;
+}
+
+int remote_inventory_find(const remote_inventory_t *inv, const char *name)
+{
+    if (!inv || !name || inv->slot_cap == 0) return -1;
+
+    size_t mask = inv->slot_cap - 1;
+    size_t h = hash_name(name) & mask;
+    while (inv->name_slots[h] != -1) {
+        int idx = inv->name_slots[h];
+        if (strcmp(machine_key(&inv->machines[idx]), name) == 0) return idx;
+        h = (h + 1) & mask;
+    }
+
+    /* Pas de nom exact : on essaie l'adresse */
+    for (size_t i = 0; i < inv->count; ++i) {
+        if (strcmp(inv->machines[i].host, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+void remote_inventory_free(remote_inventory_t *inv)
+{
+    if (!inv) return;
+    free(inv->machines);
+    free(inv->name_slots);
+    memset(inv, 0, sizeof(*inv));
+}
+
+int load_remote_config(const char *path, remote_inventory_t *inv)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror("fopen remote-config");
+        return -1;
+    }
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t n;
+
+    while ((n = getline(&line, &len, f)) != -1) {
+        if (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r'))
+            line[n - 1] = '\0';
+
+        if (line[0] == '\0' || line[0] == '#')
+            continue;
+
+        /* nom:adresse:port:user:pass:type */
+        char *saveptr = NULL;
+        char *name     = strtok_r(line, ":", &saveptr);
+        char *addr     = strtok_r(NULL, ":", &saveptr);
+        char *port_str = strtok_r(NULL, ":", &saveptr);
+        char *user     = strtok_r(NULL, ":", &saveptr);
+        char *pass     = strtok_r(NULL, ":", &saveptr);
+        char *type     = strtok_r(NULL, ":", &saveptr);
+
+        if (!name || !addr || !port_str || !user || !pass || !type)
+            continue;
+
+        int port = atoi(port_str);
+        add_remote_machine(inv, name, addr, port, user, pass, type);
+    }
+
+    free(line);
+    fclose(f);
+    return 0;
+}
+
+struct remote_fetch {
+    pid_t pid;
+    int fd;
+    char *buf;
+    size_t len;
+    size_t cap;
+    remotemachine_t *m;
+    double started;
+    int probe;
+    int thread_pid;
+};
+
+static void health_success(host_health_t *h, double rtt_ms, int probe)
+{
+    h->state = HOST_UP;
+    h->consecutive_failures = 0;
+    h->next_attempt = 0.0;
+    if (!probe) {
+        h->last_success = now_seconds();
+    }
+    /* Moyenne glissante pour lisser les fetchs lents ponctuels */
+    h->rtt_ms = (h->rtt_ms > 0.0) ? 0.7 * h->rtt_ms + 0.3 * rtt_ms : rtt_ms;
+}
+
+static void health_failure(host_health_t *h)
+{
+    h->state = HOST_DOWN;
+    h->consecutive_failures++;
+
+    double delay = NET_BACKOFF_BASE;
+    for (int i = 1; i < h->consecutive_failures && delay < NET_BACKOFF_MAX; ++i) {
+        delay *= 2.0;
+    }
+    if (delay > NET_BACKOFF_MAX) delay = NET_BACKOFF_MAX;
+    h->next_attempt = now_seconds() + delay;
+}
+
+int remote_health_due(const host_health_t *h)
+{
+    return h->state != HOST_DOWN || now_seconds() >= h->next_attempt;
+}
+
+void remote_health_describe(const host_health_t *h, char *buf, size_t size)
+{
+    double now = now_seconds();
+    char age[32] = "no data";
+    if (h->last_success > 0.0) {
+        snprintf(age, sizeof(age), "data %.0fs old", now - h->last_success);
+    }
+
+    switch (h->state) {
+    case HOST_UP:
+        snprintf(buf, size, "UP  %s  rtt %.0fms", age, h->rtt_ms);
+        break;
+    case HOST_DOWN: {
+        double wait = h->next_attempt - now;
+        if (wait < 0.0) wait = 0.0;
+        snprintf(buf, size, "DOWN x%d  retry in %.0fs  %s",
+                 h->consecutive_failures, wait, age);
+        break;
+    }
+    default:
+        snprintf(buf, size, "connecting...");
+        break;
+    }
+}
+
+/* Lit ce qui est disponible : 1 = fin du flux, 0 = à suivre, -1 = erreur */
+static int read_available(int fd, char **buf, size_t *len, size_t *cap)
+{
+    for (;;) {
+        if (*cap - *len < 4096) {
+            size_t newcap = *cap ? *cap * 2 : 16384;
+            char *tmp = realloc(*buf, newcap);
+            if (!tmp) return -1;
+            *buf = tmp;
+            *cap = newcap;
+        }
+
+        ssize_t n = read(fd, *buf + *len, *cap - *len);
+        if (n > 0) {
+            *len += (size_t)n;
+        } else if (n == 0) {
+            return 1;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+}
+
+remote_fetch_t *fetch_remote_start(remotemachine_t *m, const remote_request_t *req)
+{
+    const transport_t *t = transport_find(m->type);
+    if (!t) {
+        fprintf(stderr, "Unsupported remote type: %s\n", m->type);
+        return NULL;
+    }
+
+    int fd;
+    int probe = (m->health.state == HOST_DOWN);
+    pid_t pid = t->run_collector(m, req, probe, &fd);
+    if (pid < 0) {
+        return NULL;
+    }
+
+    remote_fetch_t *f = calloc(1, sizeof(remote_fetch_t));
+    if (!f) {
+        perror("calloc remote_fetch");
+        close(fd);
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+        return NULL;
+    }
+    f->pid = pid;
+    f->fd = fd;
+    f->m = m;
+    f->started = now_seconds();
+    f->probe = probe;
+    f->thread_pid = req ? req->thread_pid : 0;
+    return f;
+}
+
+int fetch_remote_is_probe(const remote_fetch_t *f)
+{
+    return f ? f->probe : 0;
+}
+
+int fetch_remote_poll(remote_fetch_t *f)
+{
+    if (!f) return -1;
+    int r = read_available(f->fd, &f->buf, &f->len, &f->cap);
+    if (r == 0 && now_seconds() - f->started > NET_FETCH_TIMEOUT) {
+        /* Hôte figé : le fetch échoue comme un hôte injoignable */
+        kill(f->pid, SIGKILL);
+        return 1;
+    }
+    return r;
+}
+
+/* Parse une section de la sortie (fmemopen refuse une taille nulle) */
+static FILE *open_section(char *buf, size_t len)
+{
+    return (len > 0) ? fmemopen(buf, len, "r") : NULL;
+}
+
+/* Position de la ligne marker dans la sortie, len si absente */
+static size_t find_marker(const char *buf, size_t len, const char *marker)
+{
+    size_t mlen = strlen(marker);
+    for (size_t i = 0; i + mlen <= len; ++i) {
+        if ((i == 0 || buf[i - 1] == '\n') && memcmp(buf + i, marker, mlen) == 0) {
+            return i;
+        }
+    }
+    return len;
+}
+
+int fetch_remote_finish(remote_fetch_t *f, remote_result_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!f) return -1;
+
+    close(f->fd);
+    int status = 0;
+    waitpid(f->pid, &status, 0);
+    double rtt_ms = (now_seconds() - f->started) * 1000.0;
+
+    /* 255 : échec de ssh lui-même (connexion, authentification) ;
+     * les autres codes viennent de la commande distante */
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    int reachable = (code >= 0 && code != 255 && code != 127);
+
+    if (!f->probe && reachable) {
+        /* Section ps, puis le résumé de l'hôte et éventuellement les tâches */
+        size_t host_at = find_marker(f->buf, f->len, HOST_MARKER "\n");
+        size_t threads_at = find_marker(f->buf, f->len, THREADS_MARKER "\n");
+        size_t ps_len = host_at < threads_at ? host_at : threads_at;
+
+        char *threads = NULL;
+        size_t threads_len = 0;
+        if (threads_at < f->len) {
+            threads = f->buf + threads_at + sizeof(THREADS_MARKER);
+            threads_len = f->len - (threads_at + sizeof(THREADS_MARKER));
+        }
+
+        if (host_at < f->len) {
+            size_t from = host_at + sizeof(HOST_MARKER);
+            size_t to = threads_at > host_at ? threads_at : f->len;
+            out->host = malloc(sizeof(host_sample_t));
+            if (out->host) {
+                host_sample_init(out->host);
+                host_sample_parse(out->host, f->buf + from, to - from);
+            }
+        }
+
+        /* Parse directement le tampon de lecture ; vide si rien ne
+         * correspond au filtre poussé côté distant */
+        out->processes = create_process_list_from_buffer(f->buf, ps_len);
+
+        if (f->thread_pid > 0) {
+            FILE *mem = open_section(threads, threads_len);
+            if (mem) {
+                out->threads = create_thread_list_from_stream(mem, f->thread_pid);
+                fclose(mem);
+            }
+        }
+    }
+
+    int ok = f->probe ? (code == 0) : (out->processes != NULL);
+    if (ok) {
+        health_success(&f->m->health, rtt_ms, f->probe);
+    } else {
+        health_failure(&f->m->health);
+        free(out->host);
+        out->host = NULL;
+        free_thread_list(out->threads);
+        out->threads = NULL;
+    }
+
+    free(f->buf);
+    free(f);
+    return ok ? 0 : -1;
+}
+
+/* Abandon (quitter, erreur de lecture) : l'état de l'hôte n'est pas touché */
+void fetch_remote_cancel(remote_fetch_t *f)
+{
+    if (!f) return;
+    close(f->fd);
+    kill(f->pid, SIGTERM);
+    waitpid(f->pid, NULL, 0);
+    free(f->buf);
+    free(f);
+}
+
+process_list *fetch_remote_processes(remotemachine_t *m, const process_query_t *q)
+{
+    if (!remote_health_due(&m->health)) {
+        return NULL;
+    }
+
+    remote_request_t req = { q, 0 };
+    remote_fetch_t *f = fetch_remote_start(m, &req);
+    if (!f) {
+        return NULL;
+    }
+
+    struct pollfd pfd = { .fd = f->fd, .events = POLLIN };
+    int r;
+    while ((r = fetch_remote_poll(f)) == 0) {
+        poll(&pfd, 1, 1000);
+    }
+    if (r < 0) {
+        fetch_remote_cancel(f);
+        return NULL;
+    }
+
+    int probe = f->probe;
+    remote_result_t res;
+    fetch_remote_finish(f, &res);
+    if (probe && m->health.state == HOST_UP) {
+        /* Sonde réussie : l'hôte est revenu, on fait le vrai fetch */
+        return fetch_remote_processes(m, q);
+    }
+    return res.processes;
+}
+
+/* --- Lots de signaux (actions), lus comme un fetch --- */
+
+struct remote_exec {
+    pid_t pid;
+    int fd;
+    char *buf;
+    size_t len;
+    size_t cap;
+};
+
+remote_exec_t *remote_signal_start(const remotemachine_t *m, const remote_signal_t *sigs, int n)
+{
+    const transport_t *t = transport_find(m->type);
+    if (!t) {
+        fprintf(stderr, "Unsupported remote type: %s\n", m->type);
+        return NULL;
+    }
+
+    remote_exec_t *e = calloc(1, sizeof(remote_exec_t));
+    if (!e) {
+        perror("calloc remote_exec");
+        return NULL;
+    }
+    e->pid = t->send_signals(m, sigs, n, &e->fd);
+    if (e->pid < 0) {
+        free(e);
+        return NULL;
+    }
+    return e;
+}
+
+int remote_exec_poll(remote_exec_t *e)
+{
+    if (!e) return -1;
+    return read_available(e->fd, &e->buf, &e->len, &e->cap);
+}
+
+int remote_exec_finish(remote_exec_t *e, char **out, size_t *len)
+{
+    *out = NULL;
+    *len = 0;
+    if (!e) return -1;
+
+    close(e->fd);
+    int status = 0;
+    waitpid(e->pid, &status, 0);
+    *out = e->buf;
+    *len = e->len;
+    free(e);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+void remote_exec_cancel(remote_exec_t *e)
+{
+    if (!e) return;
+    close(e->fd);
+    kill(e->pid, SIGTERM);
+    waitpid(e->pid, NULL, 0);
+    free(e->buf);
+    free(e);
+}
@@ -1,32 +1,131 @@
-#ifndef NETWORK_H
-#define NETWORK_H
-
-#include "process.h"
-
-typedef struct {
-    char name[64];
-    char host[128];
-    int  port;
-    char username[64];
-    char password[64];
-    char type[16];      /* "ssh" ici */
-} remotemachine_t;
-
-int load_remote_config(const char *path,
-                       remotemachine_t **machines,
-                       size_t *count);
-
-int add_remote_machine(remotemachine_t **machines,
-                       size_t *count,
-                       const char *name,
-                       const char *host,
-                       int port,
-                       const char *username,
-                       const char *password,
-                       const char *type);
-
-int send_remote_signal(const remotemachine_t *m, int pid, int signum);
-
-process_list *fetch_remote_processes(const remotemachine_t *m);
-
-#endif
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <stddef.h>
+#include "process.h"
+#include "filter.h"
+#include "hoststat.h"
+
+/* Délai de connexion ssh : borne le coût d'un hôte injoignable */
+#define NET_CONNECT_TIMEOUT 5
+
+/* Fetch sans fin de sortie (hôte figé) : abandonné et compté en échec */
+#define NET_FETCH_TIMEOUT 30.0
+
+/* Backoff exponentiel des hôtes en échec */
+#define NET_BACKOFF_BASE 2.0
+#define NET_BACKOFF_MAX  300.0
+
+typedef enum {
+    HOST_UNKNOWN = 0,
+    HOST_UP,
+    HOST_DOWN
+} host_state_t;
+
+/* État de connexion d'un hôte (horloge monotone, en secondes) */
+typedef struct {
+    host_state_t state;
+    double last_success;        /* dernier snapshot reçu, 0 = jamais */
+    double next_attempt;        /* pas de connexion avant cette date */
+    int consecutive_failures;
+    double rtt_ms;              /* moyenne glissante, 0 = pas encore mesuré */
+} host_health_t;
+
+typedef struct {
+    char name[64];
+    char host[128];
+    int  port;
+    char username[64];
+    char password[64];
+    char type[16];      /* transport : "ssh", "local", "sim" (voir transport.h) */
+    host_health_t health;
+} remotemachine_t;
+
+/* Inventaire de machines distantes, indexé par nom */
+typedef struct {
+    remotemachine_t *machines;
+    size_t count;
+    size_t cap;
+    int *name_slots;        /* hash nom -> index dans machines, -1 = vide */
+    size_t slot_cap;
+} remote_inventory_t;
+
+/* Fetch asynchrone : la sortie de ssh est lue sans bloquer l'UI */
+typedef struct remote_fetch remote_fetch_t;
+
+/* Ce qu'on demande à un hôte en un seul aller-retour ssh */
+typedef struct {
+    const process_query_t *query;   /* NULL = pas de filtre */
+    int thread_pid;                 /* > 0 : tâches de ce PID en plus */
+} remote_request_t;
+
+/* Un signal d'un lot ; la réponse est la ligne "@@rc ID CODE" */
+typedef struct {
+    int id;
+    int pid;
+    int signum;
+} remote_signal_t;
+
+typedef struct {
+    process_list *processes;
+    thread_list_t *threads;         /* NULL si non demandé */
+    host_sample_t *host;            /* résumé de l'hôte, NULL si absent */
+} remote_result_t;
+
+int load_remote_config(const char *path, remote_inventory_t *inv);
+
+int add_remote_machine(remote_inventory_t *inv,
+                       const char *name,
+                       const char *host,
+                       int port,
+                       const char *username,
+                       const char *password,
+                       const char *type);
+
+/* Index de la machine de ce nom (ou de cet hôte), -1 si absente */
+int remote_inventory_find(const remote_inventory_t *inv, const char *name);
+
+void remote_inventory_free(remote_inventory_t *inv);
+
+
+/* q peut être NULL (pas de filtre) */
+process_list *fetch_remote_processes(remotemachine_t *m, const process_query_t *q);
+
+/* Un hôte en backoff ne doit pas être contacté avant next_attempt */
+int remote_health_due(const host_health_t *h);
+
+/* Résumé lisible : état, âge des données, RTT ou prochain essai */
+void remote_health_describe(const host_health_t *h, char *buf, size_t size);
+
+/* Démarre un fetch. Pour un hôte DOWN, seule une sonde de connexion
+ * ("true") est lancée ; le vrai fetch suivra si elle réussit. */
+remote_fetch_t *fetch_remote_start(remotemachine_t *m, const remote_request_t *req);
+
+int fetch_remote_is_probe(const remote_fetch_t *f);
+
+/* Lit ce qui est disponible : 1 = terminé (ou délai dépassé),
+ * 0 = en cours, -1 = erreur */
+int fetch_remote_poll(remote_fetch_t *f);
+
+/* Attend la fin du processus, parse la sortie, met à jour l'état de
+ * l'hôte et libère f. Retourne -1 si la commande a échoué ; une sonde
+ * réussie retourne 0 avec un résultat vide. */
+int fetch_remote_finish(remote_fetch_t *f, remote_result_t *out);
+
+void fetch_remote_cancel(remote_fetch_t *f);
+
+/* Lot de signaux (file d'actions), lu sans bloquer */
+typedef struct remote_exec remote_exec_t;
+
+remote_exec_t *remote_signal_start(const remotemachine_t *m, const remote_signal_t *sigs, int n);
+
+/* 1 = terminé, 0 = en cours, -1 = erreur */
+int remote_exec_poll(remote_exec_t *e);
+
+/* Code de sortie (255 : échec du transport, -1 : tué) ; *out est à libérer */
+int remote_exec_finish(remote_exec_t *e, char **out, size_t *len);
+
+/* Tue la commande (hôte bloqué) et libère e */
+void remote_exec_cancel(remote_exec_t *e);
+
+#endif
@@ -1,4 +1,7 @@
+#define _POSIX_C_SOURCE 200809L
 #include "process.h"
+#include "cgroup.h"
+#include "clock.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -6,91 +9,238 @@
 #include <dirent.h>
 #include <errno.h>
 #include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fcntl.h>
+#include <pwd.h>
+#include <sys/stat.h>
+
+/* Valeurs lues une fois par rafraîchissement, communes à tous les PIDs */
+typedef struct {
+    double uptime;                  /* secondes depuis le boot */
+    double hz;
+    unsigned long long mem_total_kb;
+    unsigned long long page_kb;
+    long long now;                  /* epoch */
+} collect_ctx_t;
+
+/* Lit un petit fichier de /proc d'un coup (un seul read, pas de stdio) */
+static ssize_t read_proc_file(const char *path, char *buf, size_t size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return n;
+}
 
-#define MAX_CMD_LEN 256
-#define MAX_BUF_LEN 128
-
-static process_info_t get_process_info(struct dirent *dir)
+static void collect_ctx_init(collect_ctx_t *c)
 {
-    process_info_t process;
-    memset(&process, 0, sizeof(process));
+    char buf[256];
+    memset(c, 0, sizeof(*c));
+
+    if (read_proc_file("/proc/uptime", buf, sizeof(buf)) > 0) {
+        c->uptime = strtod(buf, NULL);
+    }
+    if (read_proc_file("/proc/meminfo", buf, sizeof(buf)) > 0) {
+        sscanf(buf, "MemTotal: %llu", &c->mem_total_kb);
+    }
+    c->hz = (double)sysconf(_SC_CLK_TCK);
+    c->page_kb = (unsigned long long)sysconf(_SC_PAGESIZE) / 1024;
+    c->now = (long long)time(NULL);
+}
 
-    int pid = (int)strtol(dir->d_name, NULL, 10);
-    process.pid = pid;
+/* Cache uid -> nom : getpwuid relit /etc/passwd à chaque appel */
+typedef struct {
+    uid_t uid;
+    char name[32];
+} user_cache_entry_t;
 
-    FILE *file;
-    char bash_line[MAX_BUF_LEN];
+static user_cache_entry_t *user_cache;
+static int user_cache_count;
+static int user_cache_cap;
 
-    // USER
-    snprintf(bash_line, sizeof(bash_line),
-             "ps -p %d -o user= 2>/dev/null", pid);
-    file = popen(bash_line, "r");
-    if (file != NULL) {
-        if (fgets(process.user, sizeof(process.user), file) != NULL) {
-            process.user[strcspn(process.user, "\n")] = '\0';
-        }
-        pclose(file);
-    } else {
-        strncpy(process.user, "unknown", sizeof(process.user));
-        process.user[sizeof(process.user) - 1] = '\0';
-    }
-
-    // %CPU
-    snprintf(bash_line, sizeof(bash_line),
-             "ps -p %d -o pcpu= 2>/dev/null", pid);
-    file = popen(bash_line, "r");
-    if (file != NULL) {
-        char buf[32];
-        if (fgets(buf, sizeof(buf), file) != NULL) {
-            process.cpu_usage = strtod(buf, NULL);
-        }
-        pclose(file);
+static const char *user_name(uid_t uid)
+{
+    for (int i = 0; i < user_cache_count; ++i) {
+        if (user_cache[i].uid == uid) return user_cache[i].name;
     }
 
-    // %MEM
-    snprintf(bash_line, sizeof(bash_line),
-             "ps -p %d -o pmem= 2>/dev/null", pid);
-    file = popen(bash_line, "r");
-    if (file != NULL) {
-        char buf[32];
-        if (fgets(buf, sizeof(buf), file) != NULL) {
-            process.mem_usage = strtod(buf, NULL);
-        }
-        pclose(file);
+    if (user_cache_count >= user_cache_cap) {
+        int newcap = user_cache_cap ? user_cache_cap * 2 : 16;
+        user_cache_entry_t *tmp = realloc(user_cache, (size_t)newcap * sizeof(*tmp));
+        if (!tmp) return "unknown";
+        user_cache = tmp;
+        user_cache_cap = newcap;
     }
 
-    // COMMAND
-    snprintf(bash_line, sizeof(bash_line),
-             "ps -p %d -o comm= 2>/dev/null", pid);
-    file = popen(bash_line, "r");
-    if (file != NULL) {
-        if (fgets(process.command, sizeof(process.command), file) != NULL) {
-            process.command[strcspn(process.command, "\n")] = '\0';
-        }
-        pclose(file);
-    } else {
-        strncpy(process.command, "unknown", sizeof(process.command));
-        process.command[sizeof(process.command) - 1] = '\0';
-    }
-
-    // STATE
-    snprintf(bash_line, sizeof(bash_line),
-             "ps -p %d -o stat= 2>/dev/null", pid);
-    file = popen(bash_line, "r");
-    if (file != NULL) {
-        char buf[8];
-        if (fgets(buf, sizeof(buf), file) != NULL) {
-            process.state = buf[0];
-        }
-        pclose(file);
+    user_cache_entry_t *e = &user_cache[user_cache_count++];
+    e->uid = uid;
+    struct passwd *pw = getpwuid(uid);
+    if (pw) {
+        strncpy(e->name, pw->pw_name, sizeof(e->name) - 1);
+        e->name[sizeof(e->name) - 1] = '\0';
     } else {
-        process.state = 'u';
+        snprintf(e->name, sizeof(e->name), "%u", (unsigned)uid);
+    }
+    return e->name;
+}
+
+/* /proc/<pid>/stat : "pid (comm) S ppid ..." ; comm peut contenir
+ * espaces et parenthèses, on se repère sur la dernière ')' */
+static int read_stat(const collect_ctx_t *c, process_info_t *p)
+{
+    char path[64];
+    char buf[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", p->pid);
+    if (read_proc_file(path, buf, sizeof(buf)) <= 0) return -1;
+
+    const char *open_p = strchr(buf, '(');
+    const char *close_p = strrchr(buf, ')');
+    if (!open_p || !close_p || close_p < open_p) return -1;
+
+    size_t n = (size_t)(close_p - open_p - 1);
+    if (n >= sizeof(p->command)) n = sizeof(p->command) - 1;
+    memcpy(p->command, open_p + 1, n);
+    p->command[n] = '\0';
+
+    unsigned long long utime = 0, stime = 0, start = 0, vsize = 0;
+    long prio = 0, nice = 0, rss = 0;
+    int scanned = sscanf(close_p + 1,
+                         " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu"
+                         " %*d %*d %ld %ld %*d %*d %llu %llu %ld",
+                         &p->state, &utime, &stime, &prio, &nice, &start, &vsize, &rss);
+    if (scanned < 8) return -1;
+
+    p->priority = (int)prio;
+    p->nice = (int)nice;
+    p->vsz_kb = vsize / 1024;
+    p->rss_kb = (rss > 0 ? (unsigned long long)rss : 0) * c->page_kb;
+
+    /* Même définition que ps : temps CPU / temps écoulé depuis le lancement */
+    double started = c->hz > 0.0 ? (double)start / c->hz : 0.0;
+    double elapsed = c->uptime - started;
+    if (elapsed > 0.0 && c->hz > 0.0) {
+        p->cpu_usage = (double)(utime + stime) / c->hz / elapsed * 100.0;
     }
+    if (c->mem_total_kb > 0) {
+        p->mem_usage = (double)p->rss_kb / (double)c->mem_total_kb * 100.0;
+    }
+    p->start_time = c->now - (long long)elapsed;
+
+    p->filled |= PROC_NEED_STAT;
+    return 0;
+}
+
+static void read_io(process_info_t *p)
+{
+    char path[64];
+    char buf[512];
+    snprintf(path, sizeof(path), "/proc/%d/io", p->pid);
+    if (read_proc_file(path, buf, sizeof(buf)) <= 0) return;   /* EACCES hors root */
+
+    const char *r = strstr(buf, "\nread_bytes:");
+    const char *w = strstr(buf, "\nwrite_bytes:");
+    if (!r || !w) return;
+    p->read_bytes = strtoull(r + 12, NULL, 10);
+    p->write_bytes = strtoull(w + 13, NULL, 10);
+    p->filled |= PROC_NEED_IO;
+}
+
+static void read_fd_count(process_info_t *p)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/fd", p->pid);
+    DIR *dir = opendir(path);
+    if (!dir) return;
 
-    return process;
+    int n = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') n++;
+    }
+    closedir(dir);
+    p->fd_count = n;
+    p->filled |= PROC_NEED_FD;
+}
+
+static void read_cmdline(process_info_t *p)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/cmdline", p->pid);
+    ssize_t n = read_proc_file(path, p->cmdline, sizeof(p->cmdline));
+    if (n < 0) return;
+
+    /* Arguments séparés par des '\0' ; vide pour les threads noyau */
+    for (ssize_t i = 0; i < n; ++i) {
+        if (p->cmdline[i] == '\0') p->cmdline[i] = ' ';
+    }
+    while (n > 0 && p->cmdline[n - 1] == ' ') p->cmdline[--n] = '\0';
+    p->filled |= PROC_NEED_CMDLINE;
+}
+
+/* Le noyau parcourt tout l'espace d'adressage pour produire ce résumé :
+ * en interactif, la lecture passe par le cache de smaps.h */
+static void read_smaps(process_info_t *p)
+{
+    char path[64];
+    char buf[2048];
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", p->pid);
+    if (read_proc_file(path, buf, sizeof(buf)) <= 0) return;   /* EACCES hors root */
+
+    const char *pss = strstr(buf, "\nPss:");
+    const char *clean = strstr(buf, "\nPrivate_Clean:");
+    const char *dirty = strstr(buf, "\nPrivate_Dirty:");
+    const char *swap = strstr(buf, "\nSwap:");
+    if (!pss || !clean || !dirty) return;
+    p->pss_kb = strtoull(pss + 5, NULL, 10);
+    p->uss_kb = strtoull(clean + 15, NULL, 10) + strtoull(dirty + 15, NULL, 10);
+    p->swap_kb = swap ? strtoull(swap + 6, NULL, 10) : 0;
+    p->filled |= PROC_NEED_SMAPS;
+}
+
+void process_fill_extra(process_info_t *p, unsigned needs)
+{
+    unsigned missing = needs & ~p->filled;
+    if (missing & PROC_NEED_IO)      read_io(p);
+    if (missing & PROC_NEED_FD)      read_fd_count(p);
+    if (missing & PROC_NEED_CMDLINE) read_cmdline(p);
+    if (missing & PROC_NEED_SMAPS)   read_smaps(p);
+}
+
+static int get_process_info(const collect_ctx_t *c, int dirfd_proc, const char *name,
+                            unsigned needs, process_info_t *process)
+{
+    memset(process, 0, sizeof(*process));
+    process->pid = (int)strtol(name, NULL, 10);
+
+    // USER : propriétaire de /proc/<pid>, pas besoin de lire status
+    struct stat st;
+    if (fstatat(dirfd_proc, name, &st, 0) != 0) return -1;   /* terminé entre-temps */
+    strncpy(process->user, user_name(st.st_uid), sizeof(process->user) - 1);
+
+    // %CPU, %MEM, COMMAND, STATE
+    if (read_stat(c, process) != 0) return -1;
+
+    if (needs & PROC_NEED_IO) read_io(process);
+    if (needs & PROC_NEED_FD) read_fd_count(process);
+    if (needs & PROC_NEED_CMDLINE) read_cmdline(process);
+
+    // CGROUP
+    if (needs & PROC_NEED_CGROUP) process->cgroup_id = cgroup_lookup_pid(process->pid);
+
+    return 0;
 }
 
 process_list *create_process_list(void)
+{
+    return create_process_list_needs(PROC_NEED_STAT | PROC_NEED_CGROUP);
+}
+
+process_list *create_process_list_needs(unsigned needs)
 {
     DIR *proc = opendir("/proc");
     if (proc == NULL) {
@@ -106,10 +256,16 @@ process_list *create_process_list(void)
     }
 
     list->head = NULL;
+    list->pool = NULL;
+    process_elem *tail = NULL;
     struct dirent *entry;
 
+    collect_ctx_t c;
+    collect_ctx_init(&c);
+    if (needs & PROC_NEED_CGROUP) cgroup_begin_refresh();
+
     while ((entry = readdir(proc)) != NULL) {
-        if (strspn(entry->d_name, "0123456789") != strlen(entry->d_name)) {
+        if (!isdigit((unsigned char)entry->d_name[0])) {
             continue;
         }
 
@@ -119,102 +275,206 @@ process_list *create_process_list(void)
             continue;
         }
 
-        elem->process = get_process_info(entry);
+        if (get_process_info(&c, dirfd(proc), entry->d_name, needs, &elem->process) != 0) {
+            free(elem);
+            continue;
+        }
         elem->next = NULL;
 
-        if (!list->head) {
-            list->head = elem;
-        } else {
-            process_elem *cur = list->head;
-            while (cur->next) {
-                cur = cur->next;
-            }
-            cur->next = elem;
-        }
+        if (!tail) list->head = elem;
+        else       tail->next = elem;
+        tail = elem;
     }
 
     closedir(proc);
+
+    /* Stats lues une fois par cgroup, pas par PID membre */
+    if (needs & PROC_NEED_CGROUP) cgroup_end_refresh();
     return list;
 }
 
 /* Helpers pour la version stream (remote/local ps -eo) */
 
-static void trim(char *s)
+static const char *skip_blanks(const char *p, const char *end)
 {
-    char *p = s;
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (p != s) memmove(s, p, strlen(p) + 1);
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+static const char *skip_token(const char *p, const char *end)
+{
+    while (p < end && *p != ' ' && *p != '\t') p++;
+    return p;
+}
 
-    size_t len = strlen(s);
-    while (len > 0 && isspace((unsigned char)s[len - 1])) {
-        s[len - 1] = '\0';
-        len--;
+static void copy_span(char *dst, size_t size, const char *p, const char *end)
+{
+    size_t n = (size_t)(end - p);
+    if (n >= size) n = size - 1;
+    memcpy(dst, p, n);
+    dst[n] = '\0';
+}
+
+/* Nombre décimal de ps ("12", "3.5") ; strtod pour tout le reste */
+static int parse_decimal(const char *p, const char *end, double *out)
+{
+    static const double scale[] = { 1, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8 };
+
+    const char *start = p;
+    unsigned long long v = 0;
+    int digits = 0, frac = -1;
+    for (; p < end && digits < 18; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            v = v * 10 + (unsigned)(*p - '0');
+            digits++;
+            if (frac >= 0) frac++;
+        } else if (*p == '.' && frac < 0) {
+            frac = 0;
+        } else {
+            break;
+        }
+    }
+    if (p == end && digits > 0 && frac <= 8) {
+        *out = (double)v * scale[frac < 0 ? 0 : frac];
+        return 0;
     }
+
+    char tmp[32], *stop;
+    copy_span(tmp, sizeof(tmp), start, end);
+    *out = strtod(tmp, &stop);
+    return (stop == tmp || *stop != '\0') ? -1 : 0;
 }
 
-/* Parse la sortie de "ps -eo pid,user,pcpu,pmem,stat,comm" */
-process_list *create_process_list_from_stream(FILE *fp)
+/* Une ligne "PID USER %CPU %MEM STAT COMMAND...", sans le '\n' */
+static int parse_ps_line(const char *p, const char *end, process_info_t *out)
 {
-    if (!fp) return NULL;
+    while (end > p && isspace((unsigned char)end[-1])) end--;
+    p = skip_blanks(p, end);
+
+    int pid = 0;
+    const char *tok = p;
+    while (p < end && *p >= '0' && *p <= '9' && pid < 100000000) pid = pid * 10 + (*p++ - '0');
+    if (p == tok || (p < end && *p != ' ' && *p != '\t')) return -1;
+
+    /* Pas de memset de la ligne entière (~700 octets pour ~45 lus) : les
+     * champs étendus sont invalides tant que filled ne les annonce pas */
+    out->pid = pid;
+    out->cgroup_id = 0;
+    out->alert = 0;
+    out->filled = 0;
+    out->cmdline[0] = '\0';
+
+    tok = skip_blanks(p, end);
+    p = skip_token(tok, end);
+    if (p == tok) return -1;
+    copy_span(out->user, sizeof(out->user), tok, p);
+
+    tok = skip_blanks(p, end);
+    p = skip_token(tok, end);
+    if (parse_decimal(tok, p, &out->cpu_usage) != 0) return -1;
+
+    tok = skip_blanks(p, end);
+    p = skip_token(tok, end);
+    if (parse_decimal(tok, p, &out->mem_usage) != 0) return -1;
+
+    tok = skip_blanks(p, end);
+    p = skip_token(tok, end);
+    if (p == tok) return -1;
+    out->state = tok[0];
+
+    /* La commande va jusqu'à la fin de la ligne, tronquée si trop longue */
+    tok = skip_blanks(p, end);
+    if (tok == end) return -1;
+    copy_span(out->command, sizeof(out->command), tok, end);
+    return 0;
+}
 
-    process_list *list = malloc(sizeof(process_list));
+process_list *create_process_list_from_buffer(const char *buf, size_t len)
+{
+    process_list *list = calloc(1, sizeof(process_list));
     if (!list) {
-        perror("malloc");
+        perror("calloc process_list");
         return NULL;
     }
-    list->head = NULL;
 
-    char line[512];
+    /* Une ligne au plus par processus : un seul bloc pour tous les éléments */
+    size_t lines = 1;
+    for (const char *p = buf, *end = buf + len; (p = memchr(p, '\n', (size_t)(end - p))) != NULL; ++p) {
+        lines++;
+    }
+    list->pool = malloc(lines * sizeof(process_elem));
+    if (!list->pool) {
+        perror("malloc process pool");
+        free(list);
+        return NULL;
+    }
+
+    const char *p = buf, *end = buf + len;
+    process_elem *tail = NULL;
+    size_t used = 0;
     int first = 1;
 
-    while (fgets(line, sizeof(line), fp)) {
-        if (first) {
-            first = 0; /* sauter l'entête */
-            continue;
+    while (p < end) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        const char *eol = nl ? nl : end;
+
+        /* La première ligne est l'entête de ps */
+        if (!first) {
+            process_elem *elem = &list->pool[used];
+            if (parse_ps_line(p, eol, &elem->process) == 0) {
+                used++;
+                elem->next = NULL;
+                if (!tail) list->head = elem;
+                else       tail->next = elem;
+                tail = elem;
+            }
         }
+        first = 0;
+        p = eol + 1;
+    }
 
-        trim(line);
-        if (line[0] == '\0') continue;
+    return list;
+}
 
-        process_elem *elem = malloc(sizeof(process_elem));
-        if (!elem) {
-            perror("malloc");
-            continue;
-        }
-        memset(&elem->process, 0, sizeof(elem->process));
-        elem->next = NULL;
+/* Parse la sortie de "ps -eo pid,user,pcpu,pmem,stat,comm" */
+process_list *create_process_list_from_stream(FILE *fp)
+{
+    if (!fp) return NULL;
 
-        process_info_t *p = &elem->process;
-        char statbuf[16];
-
-        int scanned = sscanf(line, "%d %31s %lf %lf %15s %255[^\n]",
-                             &p->pid,
-                             p->user,
-                             &p->cpu_usage,
-                             &p->mem_usage,
-                             statbuf,
-                             p->command);
-        if (scanned < 6) {
-            free(elem);
-            continue;
-        }
-        p->state = statbuf[0];
+    size_t cap = 64 * 1024, len = 0;
+    char *buf = malloc(cap);
+    if (!buf) {
+        perror("malloc");
+        return NULL;
+    }
 
-        if (!list->head) {
-            list->head = elem;
-        } else {
-            process_elem *cur = list->head;
-            while (cur->next) cur = cur->next;
-            cur->next = elem;
+    size_t n;
+    while ((n = fread(buf + len, 1, cap - len, fp)) > 0) {
+        len += n;
+        if (len == cap) {
+            char *tmp = realloc(buf, cap * 2);
+            if (!tmp) {
+                perror("realloc");
+                break;
+            }
+            buf = tmp;
+            cap *= 2;
         }
     }
 
+    process_list *list = create_process_list_from_buffer(buf, len);
+    free(buf);
     return list;
 }
 
 void free_process_list(process_list *list)
 {
     if (!list) return;
+    if (list->pool) {
+        free(list->pool);
+        free(list);
+        return;
+    }
     process_elem *cur = list->head;
     while (cur) {
         process_elem *next = cur->next;
@@ -223,3 +483,141 @@ void free_process_list(process_list *list)
     }
     free(list);
 }
+
+/* Threads : format des fichiers /proc/<pid>/task/<tid>/stat */
+
+/* "tid (comm) S ppid ... utime stime ..." ; comm peut contenir
+ * espaces et parenthèses, on se repère sur la dernière ')' */
+static int parse_task_stat(const char *line, thread_info_t *t)
+{
+    const char *open = strchr(line, '(');
+    const char *close = strrchr(line, ')');
+    if (!open || !close || close < open) return -1;
+
+    memset(t, 0, sizeof(*t));
+    t->tid = (int)strtol(line, NULL, 10);
+    if (t->tid <= 0) return -1;
+
+    size_t n = (size_t)(close - open - 1);
+    if (n >= sizeof(t->name)) n = sizeof(t->name) - 1;
+    memcpy(t->name, open + 1, n);
+    t->name[n] = '\0';
+
+    unsigned long long utime = 0, stime = 0;
+    int scanned = sscanf(close + 1,
+                         " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                         &t->state, &utime, &stime);
+    if (scanned < 3) return -1;
+
+    t->cpu_ticks = utime + stime;
+    return 0;
+}
+
+static int thread_list_push(thread_list_t *tl, int *cap, const thread_info_t *t)
+{
+    if (tl->count >= *cap) {
+        int newcap = *cap ? *cap * 2 : 16;
+        thread_info_t *tmp = realloc(tl->threads, (size_t)newcap * sizeof(thread_info_t));
+        if (!tmp) return -1;
+        tl->threads = tmp;
+        *cap = newcap;
+    }
+    tl->threads[tl->count++] = *t;
+    return 0;
+}
+
+thread_list_t *create_thread_list(int pid)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+
+    DIR *dir = opendir(path);
+    if (!dir) return NULL;
+
+    thread_list_t *tl = calloc(1, sizeof(thread_list_t));
+    if (!tl) {
+        perror("calloc thread_list");
+        closedir(dir);
+        return NULL;
+    }
+    tl->pid = pid;
+    int cap = 0;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!isdigit((unsigned char)entry->d_name[0])) continue;
+
+        char fname[300];
+        snprintf(fname, sizeof(fname), "/proc/%d/task/%s/stat", pid, entry->d_name);
+        FILE *f = fopen(fname, "r");
+        if (!f) continue;     /* tâche terminée entre-temps */
+
+        char line[512];
+        thread_info_t t;
+        if (fgets(line, sizeof(line), f) && parse_task_stat(line, &t) == 0) {
+            thread_list_push(tl, &cap, &t);
+        }
+        fclose(f);
+    }
+    closedir(dir);
+
+    tl->sampled_at = now_seconds();
+    return tl;
+}
+
+thread_list_t *create_thread_list_from_stream(FILE *fp, int pid)
+{
+    if (!fp) return NULL;
+
+    thread_list_t *tl = calloc(1, sizeof(thread_list_t));
+    if (!tl) {
+        perror("calloc thread_list");
+        return NULL;
+    }
+    tl->pid = pid;
+    int cap = 0;
+
+    char line[512];
+    thread_info_t t;
+    while (fgets(line, sizeof(line), fp)) {
+        if (parse_task_stat(line, &t) == 0) {
+            thread_list_push(tl, &cap, &t);
+        }
+    }
+
+    tl->sampled_at = now_seconds();
+    return tl;
+}
+
+void thread_list_update_usage(thread_list_t *tl, const thread_list_t *prev)
+{
+    if (!tl) return;
+
+    double ticks_per_sec = (double)sysconf(_SC_CLK_TCK);
+    double elapsed = (prev && prev->pid == tl->pid) ? tl->sampled_at - prev->sampled_at : 0.0;
+
+    for (int i = 0; i < tl->count; ++i) {
+        thread_info_t *t = &tl->threads[i];
+        t->cpu_usage = 0.0;
+        if (elapsed <= 0.0 || ticks_per_sec <= 0.0) continue;
+
+        /* Les deux listes sont dans l'ordre de /proc : recherche linéaire
+         * à partir de la même position, en général immédiate */
+        for (int k = 0; k < prev->count; ++k) {
+            const thread_info_t *o = &prev->threads[(i + k) % prev->count];
+            if (o->tid != t->tid) continue;
+            if (t->cpu_ticks >= o->cpu_ticks) {
+                t->cpu_usage = (double)(t->cpu_ticks - o->cpu_ticks) /
+                               ticks_per_sec / elapsed * 100.0;
+            }
+            break;
+        }
+    }
+}
+
+void free_thread_list(thread_list_t *tl)
+{
+    if (!tl) return;
+    free(tl->threads);
+    free(tl);
+}
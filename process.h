@@ -3,6 +3,15 @@
 
 #include <stdio.h>
 
+/* Fichiers /proc/<pid>/... lus par la collecte locale. Le registre des
+ * colonnes (columns.h) indique lesquels sont nécessaires. */
+#define PROC_NEED_STAT     0x01     /* stat : état, CPU, RSS/VSZ, nice, start */
+#define PROC_NEED_IO       0x02     /* io : octets lus / écrits */
+#define PROC_NEED_FD       0x04     /* fd/ : nombre de descripteurs */
+#define PROC_NEED_CMDLINE  0x08     /* cmdline : ligne de commande complète */
+#define PROC_NEED_CGROUP   0x10     /* cgroup : pour le regroupement par cgroup */
+#define PROC_NEED_SMAPS    0x20     /* smaps_rollup : PSS, USS, swap (coûteux, voir smaps.h) */
+
 typedef struct {
     int pid;
     char user[32];
@@ -10,6 +19,23 @@ typedef struct {
     double mem_usage;
     char state;
     char command[256];
+    int cgroup_id;          /* cgroup v2 interné (local), 0 = inconnu */
+    unsigned char alert;    /* une règle de surveillance s'est déclenchée */
+
+    /* Champs étendus, valides seulement si le bit PROC_NEED_* est dans filled */
+    unsigned filled;
+    unsigned long long rss_kb;
+    unsigned long long vsz_kb;
+    int nice;
+    int priority;
+    long long start_time;   /* epoch, en secondes */
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    int fd_count;
+    char cmdline[256];
+    unsigned long long pss_kb;      /* part proportionnelle des pages partagées */
+    unsigned long long uss_kb;      /* pages privées seulement */
+    unsigned long long swap_kb;
 } process_info_t;
 
 typedef struct process_elem {
@@ -19,14 +45,52 @@ typedef struct process_elem {
 
 typedef struct {
     process_elem *head;
+    process_elem *pool;     /* éléments alloués d'un bloc (sortie de ps), NULL sinon */
 } process_list;
 
+/* Tâche (thread) d'un processus */
+typedef struct {
+    int tid;
+    char state;
+    unsigned long long cpu_ticks;   /* utime + stime cumulés */
+    double cpu_usage;               /* % CPU depuis l'échantillon précédent */
+    char name[32];
+} thread_info_t;
+
+typedef struct {
+    int pid;
+    thread_info_t *threads;
+    int count;
+    double sampled_at;              /* horloge monotone, en secondes */
+} thread_list_t;
+
 /* Liste locale (machine sur laquelle le programme tourne) */
 process_list *create_process_list(void);
 
+/* Idem, en ne lisant que les fichiers /proc indiqués par needs (PROC_NEED_*) */
+process_list *create_process_list_needs(unsigned needs);
+
+/* Complète une ligne déjà collectée (colonnes coûteuses, lignes visibles) */
+void process_fill_extra(process_info_t *p, unsigned needs);
+
 /* Parse la sortie d’une commande type "ps -eo pid,user,pcpu,pmem,stat,comm" */
 process_list *create_process_list_from_stream(FILE *fp);
 
+/* Idem depuis un tampon déjà lu, sans le copier ni le modifier */
+process_list *create_process_list_from_buffer(const char *buf, size_t len);
+
 void free_process_list(process_list *list);
 
+/* Tâches de /proc/<pid>/task, lues seulement pour un processus déplié */
+thread_list_t *create_thread_list(int pid);
+
+/* Parse une suite de lignes au format /proc/<pid>/task/<tid>/stat
+ * (fichiers concaténés par cat côté distant) */
+thread_list_t *create_thread_list_from_stream(FILE *fp, int pid);
+
+/* Calcule le %CPU de chaque tâche à partir de l'échantillon précédent */
+void thread_list_update_usage(thread_list_t *tl, const thread_list_t *prev);
+
+void free_thread_list(thread_list_t *tl);
+
 #endif
@@ -0,0 +1,802 @@
+#define _POSIX_C_SOURCE 200809L
+#include "record.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Format (entiers little-endian) :
+ *   FILE     : "PMREC1\n\0", u32 nb_onglets, puis par onglet u8 type, u8 len, nom
+ *              puis les trames : u32 "PMFR", i64 date_ms, u16 onglet, u16 flags,
+ *              u32 taille, données
+ *   FILE.idx : "PMIDX1\n\0", puis par trame i64 date_ms, u64 offset, u16 onglet,
+ *              u16 flags, u32 réservé
+ *
+ * Données d'une trame (varints LEB128) :
+ *   nb_supprimés, PIDs supprimés (écarts croissants)
+ *   nb_changés, puis par ligne : écart de PID, u8 champs, champs présents
+ *   (%CPU et %MEM en centièmes, état, user et commande préfixés de leur longueur)
+ * Un keyframe part d'un état vide : toutes les lignes sont "changées".
+ */
+
+#define FILE_MAGIC  "PMREC1\n"
+#define IDX_MAGIC   "PMIDX1\n"
+#define MAGIC_LEN   8
+#define FRAME_MAGIC 0x52464d50u     /* "PMFR" */
+#define FRAME_HDR   20
+#define IDX_ENTRY   24
+
+#define FRAME_KEY   0x01
+
+#define FIELD_CPU   0x01
+#define FIELD_MEM   0x02
+#define FIELD_STATE 0x04
+#define FIELD_USER  0x08
+#define FIELD_CMD   0x10
+#define FIELD_ALL   0x1f
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+} buffer_t;
+
+static int buf_reserve(buffer_t *b, size_t extra)
+{
+    if (b->len + extra <= b->cap) return 0;
+    size_t newcap = b->cap ? b->cap : 4096;
+    while (newcap < b->len + extra) newcap *= 2;
+    unsigned char *tmp = realloc(b->data, newcap);
+    if (!tmp) return -1;
+    b->data = tmp;
+    b->cap = newcap;
+    return 0;
+}
+
+static void put_bytes(buffer_t *b, const void *p, size_t n)
+{
+    if (buf_reserve(b, n) != 0) return;
+    memcpy(b->data + b->len, p, n);
+    b->len += n;
+}
+
+static void put_le(buffer_t *b, unsigned long long v, int bytes)
+{
+    unsigned char tmp[8];
+    for (int i = 0; i < bytes; ++i) tmp[i] = (unsigned char)(v >> (8 * i));
+    put_bytes(b, tmp, (size_t)bytes);
+}
+
+static void put_varint(buffer_t *b, unsigned long long v)
+{
+    unsigned char tmp[10];
+    size_t n = 0;
+    do {
+        tmp[n] = (unsigned char)(v & 0x7f);
+        v >>= 7;
+        if (v) tmp[n] |= 0x80;
+        n++;
+    } while (v);
+    put_bytes(b, tmp, n);
+}
+
+static void put_string(buffer_t *b, const char *s)
+{
+    size_t n = strlen(s);
+    put_varint(b, n);
+    put_bytes(b, s, n);
+}
+
+static unsigned long long get_le(const unsigned char *p, int bytes)
+{
+    unsigned long long v = 0;
+    for (int i = 0; i < bytes; ++i) v |= (unsigned long long)p[i] << (8 * i);
+    return v;
+}
+
+/* Lecteur borné : une trame tronquée ou corrompue met err à 1 */
+typedef struct {
+    const unsigned char *p;
+    const unsigned char *end;
+    int err;
+} reader_t;
+
+static unsigned long long get_varint(reader_t *rd)
+{
+    unsigned long long v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (rd->p >= rd->end) break;
+        unsigned char c = *rd->p++;
+        v |= (unsigned long long)(c & 0x7f) << shift;
+        if (!(c & 0x80)) return v;
+    }
+    rd->err = 1;
+    return 0;
+}
+
+static void get_string(reader_t *rd, char *dst, size_t size)
+{
+    unsigned long long n = get_varint(rd);
+    if (rd->err || n > (unsigned long long)(rd->end - rd->p)) {
+        rd->err = 1;
+        dst[0] = '\0';
+        return;
+    }
+    size_t copy = n < size - 1 ? (size_t)n : size - 1;
+    memcpy(dst, rd->p, copy);
+    dst[copy] = '\0';
+    rd->p += n;
+}
+
+static unsigned int centi(double v)
+{
+    return v > 0.0 ? (unsigned int)(v * 100.0 + 0.5) : 0;
+}
+
+static int compare_pid(const void *a, const void *b)
+{
+    int pa = ((const process_info_t *)a)->pid;
+    int pb = ((const process_info_t *)b)->pid;
+    return (pa > pb) - (pa < pb);
+}
+
+static unsigned changed_fields(const process_info_t *o, const process_info_t *n)
+{
+    unsigned f = 0;
+    if (centi(o->cpu_usage) != centi(n->cpu_usage)) f |= FIELD_CPU;
+    if (centi(o->mem_usage) != centi(n->mem_usage)) f |= FIELD_MEM;
+    if (o->state != n->state)                       f |= FIELD_STATE;
+    if (strcmp(o->user, n->user) != 0)              f |= FIELD_USER;
+    if (strcmp(o->command, n->command) != 0)        f |= FIELD_CMD;
+    return f;
+}
+
+static void put_row(buffer_t *b, const process_info_t *p, unsigned fields)
+{
+    put_le(b, fields, 1);
+    if (fields & FIELD_CPU)   put_varint(b, centi(p->cpu_usage));
+    if (fields & FIELD_MEM)   put_varint(b, centi(p->mem_usage));
+    if (fields & FIELD_STATE) put_bytes(b, &p->state, 1);
+    if (fields & FIELD_USER)  put_string(b, p->user);
+    if (fields & FIELD_CMD)   put_string(b, p->command);
+}
+
+/* Encode cur (trié par PID) par rapport à prev (trié, vide pour un keyframe) */
+static void encode_delta(buffer_t *b,
+                         const process_info_t *prev, int prev_count,
+                         const process_info_t *cur, int cur_count)
+{
+    int i, j, n;
+    long long last;
+
+    /* PIDs disparus */
+    for (n = 0, i = 0, j = 0; i < prev_count; ++i) {
+        while (j < cur_count && cur[j].pid < prev[i].pid) j++;
+        if (j >= cur_count || cur[j].pid != prev[i].pid) n++;
+    }
+    put_varint(b, (unsigned long long)n);
+    for (last = 0, i = 0, j = 0; i < prev_count; ++i) {
+        while (j < cur_count && cur[j].pid < prev[i].pid) j++;
+        if (j >= cur_count || cur[j].pid != prev[i].pid) {
+            put_varint(b, (unsigned long long)(prev[i].pid - last));
+            last = prev[i].pid;
+        }
+    }
+
+    /* Lignes nouvelles ou modifiées ; le nombre est réécrit à la fin */
+    size_t count_pos = b->len;
+    put_le(b, 0, 4);
+    for (n = 0, last = 0, i = 0, j = 0; j < cur_count; ++j) {
+        while (i < prev_count && prev[i].pid < cur[j].pid) i++;
+        unsigned fields = FIELD_ALL;
+        if (i < prev_count && prev[i].pid == cur[j].pid) {
+            fields = changed_fields(&prev[i], &cur[j]);
+            if (fields == 0) continue;
+        }
+        put_varint(b, (unsigned long long)(cur[j].pid - last));
+        last = cur[j].pid;
+        put_row(b, &cur[j], fields);
+        n++;
+    }
+    if (b->data && count_pos + 4 <= b->len) {
+        for (int k = 0; k < 4; ++k) b->data[count_pos + k] = (unsigned char)(n >> (8 * k));
+    }
+}
+
+/* Applique une trame à l'état trié state/count. Retourne -1 si corrompue. */
+static int decode_delta(const unsigned char *data, size_t len,
+                        process_info_t **state, int *count)
+{
+    reader_t rd = { data, data + len, 0 };
+    process_info_t *old = *state;
+    int old_count = *count;
+
+    unsigned long long removed = get_varint(&rd);
+    if (rd.err || removed > (unsigned long long)old_count) return -1;
+
+    int *gone = malloc((size_t)(removed ? removed : 1) * sizeof(int));
+    if (!gone) return -1;
+    long long last = 0;
+    for (unsigned long long k = 0; k < removed; ++k) {
+        last += (long long)get_varint(&rd);
+        gone[k] = (int)last;
+    }
+
+    if (rd.end - rd.p < 4) rd.err = 1;
+    unsigned long long changed = rd.err ? 0 : get_le(rd.p, 4);
+    rd.p += rd.err ? 0 : 4;
+    if (rd.err || changed > (unsigned long long)(rd.end - rd.p)) {
+        free(gone);
+        return -1;
+    }
+
+    size_t cap = (size_t)old_count + (size_t)changed;
+    process_info_t *next = malloc((cap ? cap : 1) * sizeof(process_info_t));
+    if (!next) {
+        free(gone);
+        return -1;
+    }
+
+    /* Fusion de l'ancien état (moins les supprimés) et des lignes changées,
+     * les deux listes étant triées par PID */
+    int i = 0, n = 0;
+    unsigned long long g = 0;
+    last = 0;
+    for (unsigned long long k = 0; k < changed && !rd.err; ++k) {
+        last += (long long)get_varint(&rd);
+        int pid = (int)last;
+
+        while (i < old_count && old[i].pid < pid) {
+            while (g < removed && gone[g] < old[i].pid) g++;
+            if (g >= removed || gone[g] != old[i].pid) next[n++] = old[i];
+            i++;
+        }
+
+        process_info_t row;
+        if (i < old_count && old[i].pid == pid) {
+            row = old[i++];
+        } else {
+            memset(&row, 0, sizeof(row));
+            row.pid = pid;
+        }
+
+        if (rd.p >= rd.end) {
+            rd.err = 1;
+            break;
+        }
+        unsigned fields = *rd.p++;
+        if (fields & FIELD_CPU) row.cpu_usage = (double)get_varint(&rd) / 100.0;
+        if (fields & FIELD_MEM) row.mem_usage = (double)get_varint(&rd) / 100.0;
+        if (fields & FIELD_STATE) {
+            if (rd.p < rd.end) row.state = (char)*rd.p++;
+            else rd.err = 1;
+        }
+        if (fields & FIELD_USER) get_string(&rd, row.user, sizeof(row.user));
+        if (fields & FIELD_CMD)  get_string(&rd, row.command, sizeof(row.command));
+        next[n++] = row;
+    }
+    while (i < old_count) {
+        while (g < removed && gone[g] < old[i].pid) g++;
+        if (g >= removed || gone[g] != old[i].pid) next[n++] = old[i];
+        i++;
+    }
+    free(gone);
+
+    if (rd.err) {
+        free(next);
+        return -1;
+    }
+
+    free(old);
+    *state = next;
+    *count = n;
+    return 0;
+}
+
+/* --- Codec --- */
+
+typedef struct {
+    process_info_t *rows;       /* dernier snapshot encodé / décodé, trié par PID */
+    int count;
+    int since_key;              /* trames depuis le dernier keyframe, -1 = aucune */
+} record_state_t;
+
+struct record_codec {
+    record_state_t *tabs;
+    int tab_count;
+    buffer_t buf;
+};
+
+unsigned char *record_header_encode(const record_tab_t *tabs, int tab_count, size_t *len)
+{
+    buffer_t b = { 0 };
+    put_bytes(&b, FILE_MAGIC, MAGIC_LEN);
+    put_le(&b, (unsigned long long)tab_count, 4);
+    for (int t = 0; t < tab_count; ++t) {
+        size_t n = strnlen(tabs[t].name, sizeof(tabs[t].name));
+        if (n > 255) n = 255;
+        put_le(&b, (unsigned long long)tabs[t].kind, 1);
+        put_le(&b, n, 1);
+        put_bytes(&b, tabs[t].name, n);
+    }
+    *len = b.len;
+    return b.data;
+}
+
+long record_header_decode(const unsigned char *data, size_t avail,
+                          record_tab_t **tabs, int *tab_count)
+{
+    if (avail < MAGIC_LEN + 4) return 0;
+    if (memcmp(data, FILE_MAGIC, MAGIC_LEN) != 0) return -1;
+
+    const unsigned char *p = data + MAGIC_LEN + 4;
+    const unsigned char *end = data + avail;
+    unsigned long long n = get_le(data + MAGIC_LEN, 4);
+    if (n == 0 || n > 4096) return -1;
+
+    /* Entête complet avant toute allocation */
+    for (unsigned long long t = 0; t < n; ++t) {
+        if (end - p < 2 || end - p < 2 + p[1]) return 0;
+        p += 2 + p[1];
+    }
+    long size = (long)(p - data);
+
+    record_tab_t *out = calloc((size_t)n, sizeof(record_tab_t));
+    if (!out) return -1;
+    p = data + MAGIC_LEN + 4;
+    for (unsigned long long t = 0; t < n; ++t) {
+        out[t].kind = p[0] == RECORD_TAB_FLEET ? RECORD_TAB_FLEET : RECORD_TAB_HOST;
+        size_t len = p[1] < sizeof(out[t].name) ? p[1] : sizeof(out[t].name) - 1;
+        memcpy(out[t].name, p + 2, len);
+        p += 2 + p[1];
+    }
+    *tabs = out;
+    *tab_count = (int)n;
+    return size;
+}
+
+record_codec_t *record_codec_new(int tab_count)
+{
+    record_codec_t *c = calloc(1, sizeof(record_codec_t));
+    if (!c) return NULL;
+    c->tabs = calloc((size_t)(tab_count > 0 ? tab_count : 1), sizeof(record_state_t));
+    if (!c->tabs) {
+        free(c);
+        return NULL;
+    }
+    c->tab_count = tab_count;
+    for (int t = 0; t < tab_count; ++t) c->tabs[t].since_key = -1;
+    return c;
+}
+
+void record_codec_free(record_codec_t *c)
+{
+    if (!c) return;
+    for (int t = 0; t < c->tab_count; ++t) {
+        free(c->tabs[t].rows);
+    }
+    free(c->tabs);
+    free(c->buf.data);
+    free(c);
+}
+
+/* Entête de trame + delta de cur par rapport à prev dans c->buf */
+static int encode_frame(record_codec_t *c, int tab, long long ts_ms, int key,
+                        const process_info_t *prev, int prev_count,
+                        const process_info_t *cur, int cur_count,
+                        const unsigned char **frame, size_t *len)
+{
+    buffer_t *b = &c->buf;
+    b->len = 0;
+    put_le(b, FRAME_MAGIC, 4);
+    put_le(b, (unsigned long long)ts_ms, 8);
+    put_le(b, (unsigned long long)tab, 2);
+    put_le(b, key ? FRAME_KEY : 0, 2);
+    put_le(b, 0, 4);
+    encode_delta(b, prev, prev_count, cur, cur_count);
+    if (!b->data || b->len < FRAME_HDR) return -1;
+
+    size_t payload = b->len - FRAME_HDR;
+    for (int k = 0; k < 4; ++k) b->data[16 + k] = (unsigned char)(payload >> (8 * k));
+    *frame = b->data;
+    *len = b->len;
+    return 0;
+}
+
+int record_codec_encode(record_codec_t *c, int tab, long long ts_ms,
+                        const process_info_t *procs, int count,
+                        const unsigned char **frame, size_t *len)
+{
+    if (!c || tab < 0 || tab >= c->tab_count) return -1;
+    record_state_t *st = &c->tabs[tab];
+
+    process_info_t *cur = malloc((size_t)(count > 0 ? count : 1) * sizeof(process_info_t));
+    if (!cur) {
+        perror("malloc record");
+        return -1;
+    }
+    if (count > 0) memcpy(cur, procs, (size_t)count * sizeof(process_info_t));
+    qsort(cur, (size_t)count, sizeof(process_info_t), compare_pid);
+
+    int key = (st->since_key < 0 || st->since_key + 1 >= RECORD_KEYFRAME_INTERVAL);
+    if (encode_frame(c, tab, ts_ms, key, key ? NULL : st->rows, key ? 0 : st->count,
+                     cur, count, frame, len) != 0) {
+        free(cur);
+        return -1;
+    }
+
+    free(st->rows);
+    st->rows = cur;
+    st->count = count;
+    st->since_key = key ? 0 : st->since_key + 1;
+    return 0;
+}
+
+int record_codec_keyframe(record_codec_t *c, int tab, long long ts_ms,
+                          const unsigned char **frame, size_t *len)
+{
+    if (!c || tab < 0 || tab >= c->tab_count) return -1;
+    const record_state_t *st = &c->tabs[tab];
+    return encode_frame(c, tab, ts_ms, 1, NULL, 0, st->rows, st->count, frame, len);
+}
+
+long record_frame_size(const unsigned char *data, size_t avail)
+{
+    if (avail < FRAME_HDR) return 0;
+    if (get_le(data, 4) != FRAME_MAGIC) return -1;
+    unsigned long long len = get_le(data + 16, 4);
+    if (len > (1u << 30)) return -1;
+    return (FRAME_HDR + len <= avail) ? (long)(FRAME_HDR + len) : 0;
+}
+
+int record_codec_decode(record_codec_t *c, const unsigned char *frame, size_t len,
+                        int *tab, long long *ts_ms)
+{
+    if (!c || record_frame_size(frame, len) != (long)len) return -1;
+    int t = (int)get_le(frame + 12, 2);
+    if (t >= c->tab_count) return -1;
+
+    record_state_t *st = &c->tabs[t];
+    if (get_le(frame + 14, 2) & FRAME_KEY) {
+        /* Un keyframe repart d'un état vide */
+        free(st->rows);
+        st->rows = NULL;
+        st->count = 0;
+    }
+    if (decode_delta(frame + FRAME_HDR, len - FRAME_HDR, &st->rows, &st->count) != 0) {
+        return -1;
+    }
+    *tab = t;
+    *ts_ms = (long long)get_le(frame + 4, 8);
+    return 0;
+}
+
+const process_info_t *record_codec_rows(const record_codec_t *c, int tab, int *count)
+{
+    *count = 0;
+    if (!c || tab < 0 || tab >= c->tab_count) return NULL;
+    *count = c->tabs[tab].count;
+    return c->tabs[tab].rows;
+}
+
+/* --- Écriture --- */
+
+struct recorder {
+    FILE *data;
+    FILE *idx;
+    long long offset;
+    long long last_ts;
+    record_codec_t *codec;
+};
+
+static char *idx_path(const char *path)
+{
+    size_t n = strlen(path) + 5;
+    char *p = malloc(n);
+    if (p) snprintf(p, n, "%s.idx", path);
+    return p;
+}
+
+recorder_t *record_open(const char *path, const record_tab_t *tabs, int tab_count)
+{
+    recorder_t *r = calloc(1, sizeof(recorder_t));
+    char *ipath = idx_path(path);
+    if (!r || !ipath) {
+        perror("calloc recorder");
+        free(r);
+        free(ipath);
+        return NULL;
+    }
+
+    r->data = fopen(path, "wb");
+    r->idx = fopen(ipath, "wb");
+    free(ipath);
+    r->codec = record_codec_new(tab_count);
+    if (!r->data || !r->idx || !r->codec) {
+        perror("record_open");
+        record_close(r);
+        return NULL;
+    }
+
+    size_t len = 0;
+    unsigned char *hdr = record_header_encode(tabs, tab_count, &len);
+    if (!hdr || fwrite(hdr, 1, len, r->data) != len ||
+        fwrite(IDX_MAGIC, 1, MAGIC_LEN, r->idx) != MAGIC_LEN) {
+        perror("record_open");
+        free(hdr);
+        record_close(r);
+        return NULL;
+    }
+    free(hdr);
+    r->offset = (long long)len;
+    fflush(r->data);
+    fflush(r->idx);
+    return r;
+}
+
+int record_write(recorder_t *r, int tab, long long ts_ms,
+                 const process_info_t *procs, int count)
+{
+    if (!r) return -1;
+
+    /* Dates croissantes dans l'index, même si l'horloge recule */
+    if (ts_ms < r->last_ts) ts_ms = r->last_ts;
+    r->last_ts = ts_ms;
+
+    const unsigned char *frame;
+    size_t len;
+    if (record_codec_encode(r->codec, tab, ts_ms, procs, count, &frame, &len) != 0) {
+        return -1;
+    }
+    unsigned flags = (unsigned)get_le(frame + 14, 2);
+
+    buffer_t e = { 0 };
+    put_le(&e, (unsigned long long)ts_ms, 8);
+    put_le(&e, (unsigned long long)r->offset, 8);
+    put_le(&e, (unsigned long long)tab, 2);
+    put_le(&e, flags, 2);
+    put_le(&e, 0, 4);
+
+    /* La trame d'abord : une entrée d'index pointe toujours vers des données */
+    int ok = fwrite(frame, 1, len, r->data) == len && fflush(r->data) == 0 &&
+             e.data && fwrite(e.data, 1, e.len, r->idx) == e.len && fflush(r->idx) == 0;
+    free(e.data);
+    if (!ok) {
+        perror("record_write");
+        return -1;
+    }
+    r->offset += (long long)len;
+    return 0;
+}
+
+void record_close(recorder_t *r)
+{
+    if (!r) return;
+    if (r->data) fclose(r->data);
+    if (r->idx) fclose(r->idx);
+    record_codec_free(r->codec);
+    free(r);
+}
+
+/* --- Relecture --- */
+
+typedef struct {
+    size_t *frames;             /* trames de l'onglet (indices dans l'index) */
+    size_t count;
+} replay_tab_frames_t;
+
+struct replay {
+    const unsigned char *data;
+    size_t data_len;
+    const unsigned char *idx;
+    size_t frame_count;
+    size_t idx_len;
+
+    record_tab_t *tabs;
+    replay_tab_frames_t *tab_frames;
+    int tab_count;
+};
+
+static const unsigned char *map_file(const char *path, size_t *len)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < MAGIC_LEN) {
+        fprintf(stderr, "%s: not a recording\n", path);
+        close(fd);
+        return NULL;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+    *len = (size_t)st.st_size;
+    return p;
+}
+
+static const unsigned char *idx_entry(const replay_t *r, size_t frame)
+{
+    return r->idx + MAGIC_LEN + frame * IDX_ENTRY;
+}
+
+static int entry_tab(const replay_t *r, size_t frame)
+{
+    return (int)get_le(idx_entry(r, frame) + 16, 2);
+}
+
+/* Trame désignée par une entrée de l'index, NULL si elle déborde du
+ * fichier (index corrompu, enregistrement tronqué) ; *len : taille des
+ * données après l'en-tête */
+static const unsigned char *frame_at(const replay_t *r, const unsigned char *entry, size_t *len)
+{
+    unsigned long long off = get_le(entry + 8, 8);
+    if (off > r->data_len || r->data_len - off < FRAME_HDR) return NULL;
+    unsigned long long n = get_le(r->data + off + 16, 4);
+    if (n > r->data_len - off - FRAME_HDR) return NULL;
+    *len = (size_t)n;
+    return r->data + off;
+}
+
+replay_t *replay_open(const char *path)
+{
+    replay_t *r = calloc(1, sizeof(replay_t));
+    char *ipath = idx_path(path);
+    if (!r || !ipath) {
+        perror("calloc replay");
+        free(r);
+        free(ipath);
+        return NULL;
+    }
+
+    r->data = map_file(path, &r->data_len);
+    r->idx = r->data ? map_file(ipath, &r->idx_len) : NULL;
+    free(ipath);
+    if (!r->data || !r->idx ||
+        memcmp(r->data, FILE_MAGIC, MAGIC_LEN) != 0 ||
+        memcmp(r->idx, IDX_MAGIC, MAGIC_LEN) != 0 ||
+        r->data_len < MAGIC_LEN + 4) {
+        if (r->data && r->idx) fprintf(stderr, "%s: not a recording\n", path);
+        replay_close(r);
+        return NULL;
+    }
+
+    /* Entête : noms des onglets */
+    if (record_header_decode(r->data, r->data_len, &r->tabs, &r->tab_count) <= 0) {
+        fprintf(stderr, "%s: bad header\n", path);
+        replay_close(r);
+        return NULL;
+    }
+    r->tab_frames = calloc((size_t)r->tab_count, sizeof(replay_tab_frames_t));
+    if (!r->tab_frames) {
+        perror("calloc replay tabs");
+        replay_close(r);
+        return NULL;
+    }
+
+    /* Entrées complètes dont la trame est entièrement écrite (un enregistrement
+     * interrompu peut laisser une fin tronquée) */
+    size_t entries = (r->idx_len - MAGIC_LEN) / IDX_ENTRY;
+    while (entries > 0) {
+        size_t len;
+        if (frame_at(r, r->idx + MAGIC_LEN + (entries - 1) * IDX_ENTRY, &len)) break;
+        entries--;
+    }
+    r->frame_count = entries;
+
+    /* Trames de chaque onglet, pour retrouver le keyframe sans tout parcourir */
+    for (size_t f = 0; f < r->frame_count; ++f) {
+        int t = entry_tab(r, f);
+        if (t < 0 || t >= r->tab_count) continue;
+        replay_tab_frames_t *tf = &r->tab_frames[t];
+        if ((tf->count & (tf->count - 1)) == 0) {
+            size_t newcap = tf->count ? tf->count * 2 : 16;
+            size_t *tmp = realloc(tf->frames, newcap * sizeof(size_t));
+            if (!tmp) {
+                perror("realloc replay frames");
+                replay_close(r);
+                return NULL;
+            }
+            tf->frames = tmp;
+        }
+        tf->frames[tf->count++] = f;
+    }
+    return r;
+}
+
+void replay_close(replay_t *r)
+{
+    if (!r) return;
+    if (r->data) munmap((void *)r->data, r->data_len);
+    if (r->idx) munmap((void *)r->idx, r->idx_len);
+    for (int t = 0; r->tab_frames && t < r->tab_count; ++t) {
+        free(r->tab_frames[t].frames);
+    }
+    free(r->tab_frames);
+    free(r->tabs);
+    free(r);
+}
+
+int replay_tab_count(const replay_t *r)
+{
+    return r ? r->tab_count : 0;
+}
+
+const record_tab_t *replay_tab(const replay_t *r, int tab)
+{
+    if (!r || tab < 0 || tab >= r->tab_count) return NULL;
+    return &r->tabs[tab];
+}
+
+size_t replay_frame_count(const replay_t *r)
+{
+    return r ? r->frame_count : 0;
+}
+
+long long replay_frame_time(const replay_t *r, size_t frame)
+{
+    if (!r || frame >= r->frame_count) return 0;
+    return (long long)get_le(idx_entry(r, frame), 8);
+}
+
+size_t replay_find(const replay_t *r, long long ts_ms)
+{
+    size_t lo = 0, hi = replay_frame_count(r);
+    /* Première trame de date > ts_ms */
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (replay_frame_time(r, mid) <= ts_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo > 0 ? lo - 1 : 0;
+}
+
+int replay_tab_at(const replay_t *r, int tab, size_t frame,
+                  process_info_t **out, int *count)
+{
+    *out = NULL;
+    *count = 0;
+    if (!r || tab < 0 || tab >= r->tab_count) return -1;
+
+    /* Dernière trame de l'onglet <= frame */
+    const replay_tab_frames_t *tf = &r->tab_frames[tab];
+    size_t lo = 0, hi = tf->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tf->frames[mid] <= frame) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return 0;
+    size_t last = lo - 1;
+
+    /* Remontée au keyframe, au plus RECORD_KEYFRAME_INTERVAL trames */
+    size_t first = last;
+    while (first > 0 && !(get_le(idx_entry(r, tf->frames[first]) + 18, 2) & FRAME_KEY)) {
+        first--;
+    }
+
+    for (size_t k = first; k <= last; ++k) {
+        /* Seules les dernières entrées sont vérifiées à l'ouverture */
+        size_t len = 0;
+        const unsigned char *hdr = frame_at(r, idx_entry(r, tf->frames[k]), &len);
+        if (!hdr || get_le(hdr, 4) != FRAME_MAGIC || (int)get_le(hdr + 12, 2) != tab ||
+            decode_delta(hdr + FRAME_HDR, len, out, count) != 0) {
+            /* Trame corrompue : pas de message, l'UI est active */
+            free(*out);
+            *out = NULL;
+            *count = 0;
+            return -1;
+        }
+    }
+    return 0;
+}
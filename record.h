@@ -0,0 +1,91 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stddef.h>
+#include "process.h"
+
+/* Un keyframe (snapshot complet) toutes les N trames d'un même onglet,
+ * les trames intermédiaires ne contiennent que les changements */
+#define RECORD_KEYFRAME_INTERVAL 32
+
+typedef enum {
+    RECORD_TAB_HOST = 0,
+    RECORD_TAB_FLEET            /* non enregistré, recalculé au replay */
+} record_tab_kind_t;
+
+typedef struct {
+    char name[64];
+    record_tab_kind_t kind;
+} record_tab_t;
+
+/* Entête décrivant les onglets, en tête de fichier ou de connexion au
+ * démon. Le tampon retourné est à libérer. */
+unsigned char *record_header_encode(const record_tab_t *tabs, int tab_count, size_t *len);
+
+/* Retourne la taille de l'entête, 0 s'il est incomplet, -1 s'il est
+ * invalide. *tabs est alloué. */
+long record_header_decode(const unsigned char *data, size_t avail,
+                          record_tab_t **tabs, int *tab_count);
+
+/* Codec des trames, commun à l'enregistrement et au démon : il garde le
+ * dernier snapshot de chaque onglet et encode les suivants en delta. */
+typedef struct record_codec record_codec_t;
+
+record_codec_t *record_codec_new(int tab_count);
+void record_codec_free(record_codec_t *c);
+
+/* Trame complète (entête compris) pour un snapshot, valide jusqu'au
+ * prochain appel sur ce codec */
+int record_codec_encode(record_codec_t *c, int tab, long long ts_ms,
+                        const process_info_t *procs, int count,
+                        const unsigned char **frame, size_t *len);
+
+/* Keyframe de l'état courant d'un onglet, sans le modifier */
+int record_codec_keyframe(record_codec_t *c, int tab, long long ts_ms,
+                          const unsigned char **frame, size_t *len);
+
+/* Taille de la trame qui commence en data, 0 si incomplète, -1 si invalide */
+long record_frame_size(const unsigned char *data, size_t avail);
+
+/* Applique une trame à l'état de son onglet */
+int record_codec_decode(record_codec_t *c, const unsigned char *frame, size_t len,
+                        int *tab, long long *ts_ms);
+
+/* Dernier état d'un onglet, trié par PID */
+const process_info_t *record_codec_rows(const record_codec_t *c, int tab, int *count);
+
+/* Enregistrement : FILE contient les trames, FILE.idx une entrée de
+ * taille fixe (date, offset, onglet) par trame, triée par date. */
+typedef struct recorder recorder_t;
+
+recorder_t *record_open(const char *path, const record_tab_t *tabs, int tab_count);
+
+/* Ajoute le snapshot d'un onglet (date en ms depuis l'epoch) */
+int record_write(recorder_t *r, int tab, long long ts_ms,
+                 const process_info_t *procs, int count);
+
+void record_close(recorder_t *r);
+
+/* Relecture : les deux fichiers sont projetés en mémoire, seules les trames
+ * nécessaires à la date demandée sont décodées. */
+typedef struct replay replay_t;
+
+replay_t *replay_open(const char *path);
+void replay_close(replay_t *r);
+
+int replay_tab_count(const replay_t *r);
+const record_tab_t *replay_tab(const replay_t *r, int tab);
+
+/* Trames, tous onglets confondus, par date croissante */
+size_t replay_frame_count(const replay_t *r);
+long long replay_frame_time(const replay_t *r, size_t frame);
+
+/* Dernière trame de date <= ts_ms (0 si ts_ms précède l'enregistrement) */
+size_t replay_find(const replay_t *r, long long ts_ms);
+
+/* Snapshot de l'onglet tel qu'il était à la trame donnée.
+ * *out est alloué (à libérer), *count = 0 si l'onglet n'avait rien reçu. */
+int replay_tab_at(const replay_t *r, int tab, size_t frame,
+                  process_info_t **out, int *count);
+
+#endif
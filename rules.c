@@ -0,0 +1,391 @@
+#define _POSIX_C_SOURCE 200809L
+#include "rules.h"
+#include "filter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+typedef struct {
+    char text[128];             /* ligne d'origine, pour les messages */
+    filter_t filter;            /* condition sur chaque ligne */
+    int has_count;
+    unsigned char count_op;
+    double count_value;
+    double for_sec;
+    char exec[256];
+} watch_rule_t;
+
+/* Suivi par PID des lignes qui vérifient une règle */
+typedef struct {
+    int pid;                    /* 0 = case vide */
+    int fired;
+    double since;
+    unsigned int gen;
+} watch_entry_t;
+
+typedef struct {
+    watch_entry_t *slots;
+    size_t cap;
+    size_t used;
+    int fired;                  /* règles "count" : état de l'onglet */
+    double since;
+} watch_state_t;
+
+struct rules {
+    watch_rule_t *rules;
+    int rule_count;
+
+    watch_state_t *states;      /* [onglet * rule_count + règle] */
+    int state_tabs;
+    unsigned int gen;
+    int exec_enabled;
+};
+
+/* --- Compilation --- */
+
+static void unquote(const char *src, char *dst, size_t size)
+{
+    size_t n = strlen(src);
+    if (n >= 2 && src[0] == '"' && src[n - 1] == '"') {
+        src++;
+        n -= 2;
+    }
+    if (n >= size) n = size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+static int parse_number(const char *s, double *out)
+{
+    char *end;
+    *out = strtod(s, &end);
+    return (end == s || *end != '\0') ? -1 : 0;
+}
+
+static int parse_duration(const char *s, double *out)
+{
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || v < 0.0) return -1;
+    if (*end == '\0' || strcmp(end, "s") == 0) *out = v;
+    else if (strcmp(end, "m") == 0)            *out = v * 60.0;
+    else if (strcmp(end, "h") == 0)            *out = v * 3600.0;
+    else return -1;
+    return 0;
+}
+
+/* Découpe sur les blancs, sauf entre guillemets */
+static int tokenize(char *line, char **tok, int max)
+{
+    int n = 0;
+    char *p = line;
+    while (*p && n < max) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') break;
+        tok[n++] = p;
+        int quoted = 0;
+        while (*p && (quoted || (*p != ' ' && *p != '\t'))) {
+            if (*p == '"') quoted = !quoted;
+            p++;
+        }
+        if (*p) *p++ = '\0';
+    }
+    return n;
+}
+
+/* Les mots-clés for/exec/count sont retirés, le reste de la ligne est
+ * l'expression de filtre évaluée sur chaque ligne */
+static int compile_rule(char *line, watch_rule_t *r)
+{
+    char *tok[32];
+    int n = tokenize(line, tok, 32);
+    char expr[512] = "";
+    size_t len = 0;
+
+    memset(r, 0, sizeof(*r));
+
+    for (int i = 0; i < n; ++i) {
+        if (strcmp(tok[i], "for") == 0) {
+            if (++i >= n || parse_duration(tok[i], &r->for_sec) != 0) return -1;
+        } else if (strcmp(tok[i], "exec") == 0) {
+            if (++i >= n) return -1;
+            unquote(tok[i], r->exec, sizeof(r->exec));
+        } else if (strncmp(tok[i], "count", 5) == 0 && strchr("<>=!", tok[i][5])) {
+            const char *v = tok[i] + 5;
+            if (filter_parse_op(&v, &r->count_op) != 0 || r->count_op == FO_MATCH ||
+                parse_number(v, &r->count_value) != 0) {
+                return -1;
+            }
+            r->has_count = 1;
+        } else {
+            int w = snprintf(expr + len, sizeof(expr) - len, "%s%s", len ? " " : "", tok[i]);
+            if (w < 0 || (size_t)w >= sizeof(expr) - len) return -1;
+            len += (size_t)w;
+        }
+    }
+    if (filter_compile(expr, &r->filter, NULL, 0) != 0) return -1;
+    return (r->filter.code_len > 0 || r->has_count) ? 0 : -1;
+}
+
+rules_t *rules_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+
+    rules_t *rs = calloc(1, sizeof(rules_t));
+    if (!rs) {
+        perror("calloc rules");
+        fclose(f);
+        return NULL;
+    }
+    rs->exec_enabled = 1;
+
+    char line[512];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        /* Sans '\n' avant la fin du fichier, fgets a coupé la ligne : la
+         * suite serait lue comme une autre règle */
+        if (!strchr(line, '\n') && getc(f) != EOF) {
+            fprintf(stderr, "%s:%d: rule too long (max %zu bytes)\n", path, lineno, sizeof(line) - 2);
+            fclose(f);
+            rules_free(rs);
+            return NULL;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '#') continue;
+
+        watch_rule_t *tmp = realloc(rs->rules, (size_t)(rs->rule_count + 1) * sizeof(watch_rule_t));
+        if (!tmp) {
+            perror("realloc rules");
+            break;
+        }
+        rs->rules = tmp;
+
+        char text[128];
+        snprintf(text, sizeof(text), "%.127s", p);
+        watch_rule_t *r = &rs->rules[rs->rule_count];
+        if (compile_rule(p, r) != 0) {
+            fprintf(stderr, "%s:%d: invalid rule: %s\n", path, lineno, text);
+            fclose(f);
+            rules_free(rs);
+            return NULL;
+        }
+        snprintf(r->text, sizeof(r->text), "%s", text);
+        rs->rule_count++;
+    }
+
+    fclose(f);
+    return rs;
+}
+
+void rules_free(rules_t *rs)
+{
+    if (!rs) return;
+    for (int i = 0; i < rs->state_tabs * rs->rule_count; ++i) {
+        free(rs->states[i].slots);
+    }
+    free(rs->states);
+    free(rs->rules);
+    free(rs);
+}
+
+int rules_count(const rules_t *rs)
+{
+    return rs ? rs->rule_count : 0;
+}
+
+void rules_set_exec(rules_t *rs, int enabled)
+{
+    if (rs) rs->exec_enabled = enabled;
+}
+
+/* --- Évaluation --- */
+
+static unsigned long hash_pid(int pid)
+{
+    return (unsigned long)(unsigned int)pid * 2654435761u;
+}
+
+static int state_rehash(watch_state_t *st, size_t newcap, unsigned int keep_gen, int only_gen)
+{
+    watch_entry_t *slots = calloc(newcap, sizeof(watch_entry_t));
+    if (!slots) return -1;
+
+    size_t used = 0;
+    for (size_t i = 0; i < st->cap; ++i) {
+        const watch_entry_t *e = &st->slots[i];
+        if (e->pid == 0 || (only_gen && e->gen != keep_gen)) continue;
+        size_t h = hash_pid(e->pid) & (newcap - 1);
+        while (slots[h].pid != 0) h = (h + 1) & (newcap - 1);
+        slots[h] = *e;
+        used++;
+    }
+
+    free(st->slots);
+    st->slots = slots;
+    st->cap = newcap;
+    st->used = used;
+    return 0;
+}
+
+static watch_entry_t *state_get(watch_state_t *st, int pid)
+{
+    if ((st->used + 1) * 2 > st->cap) {
+        if (state_rehash(st, st->cap ? st->cap * 2 : 16, 0, 0) != 0) return NULL;
+    }
+
+    size_t mask = st->cap - 1;
+    size_t h = hash_pid(pid) & mask;
+    while (st->slots[h].pid != 0) {
+        if (st->slots[h].pid == pid) return &st->slots[h];
+        h = (h + 1) & mask;
+    }
+    st->slots[h].pid = pid;
+    st->slots[h].fired = 0;
+    st->slots[h].since = -1.0;
+    st->used++;
+    return &st->slots[h];
+}
+
+/* Oublie les PIDs qui ne vérifient plus la règle */
+static void state_sweep(watch_state_t *st, unsigned int gen, size_t live)
+{
+    if (live == st->used) return;
+    size_t cap = 16;
+    while (cap < live * 2) cap <<= 1;
+    state_rehash(st, cap, gen, 1);
+}
+
+static watch_state_t *tab_states(rules_t *rs, int tab)
+{
+    if (tab >= rs->state_tabs) {
+        int n = tab + 1;
+        watch_state_t *tmp = realloc(rs->states, (size_t)(n * rs->rule_count) * sizeof(watch_state_t));
+        if (!tmp) return NULL;
+        memset(tmp + rs->state_tabs * rs->rule_count, 0,
+               (size_t)((n - rs->state_tabs) * rs->rule_count) * sizeof(watch_state_t));
+        rs->states = tmp;
+        rs->state_tabs = n;
+    }
+    return &rs->states[tab * rs->rule_count];
+}
+
+/* Lancée en double fork : pas d'enfant à attendre, ni de zombie */
+static void run_hook(const watch_rule_t *r, const char *host, int pid)
+{
+    pid_t child = fork();
+    if (child < 0) return;
+    if (child == 0) {
+        if (fork() == 0) {
+            char pidbuf[16];
+            snprintf(pidbuf, sizeof(pidbuf), "%d", pid);
+            setenv("WATCH_RULE", r->text, 1);
+            setenv("WATCH_HOST", host, 1);
+            setenv("WATCH_PID", pidbuf, 1);
+
+            int devnull = open("/dev/null", O_RDWR);
+            if (devnull >= 0) {
+                dup2(devnull, STDIN_FILENO);
+                dup2(devnull, STDOUT_FILENO);
+                dup2(devnull, STDERR_FILENO);
+                close(devnull);
+            }
+            execl("/bin/sh", "sh", "-c", r->exec, (char *)NULL);
+        }
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+}
+
+static int fire(rules_t *rs, const watch_rule_t *r, const char *host,
+                const process_info_t *row, int matches, int fired,
+                char *msg, size_t msg_size)
+{
+    if (fired == 0 && msg && msg_size > 0) {
+        if (row) {
+            snprintf(msg, msg_size, "ALERT %s: %s (pid %d %s)",
+                     host, r->text, row->pid, row->command);
+        } else {
+            snprintf(msg, msg_size, "ALERT %s: %s (%d processes)", host, r->text, matches);
+        }
+    }
+    if (rs->exec_enabled && r->exec[0] != '\0') {
+        run_hook(r, host, row ? row->pid : 0);
+    }
+    return fired + 1;
+}
+
+int rules_eval(rules_t *rs, int tab, const char *host, double now,
+               process_info_t *procs, int count, char *msg, size_t msg_size)
+{
+    if (!rs || rs->rule_count == 0 || tab < 0) return 0;
+    watch_state_t *states = tab_states(rs, tab);
+    if (!states) return 0;
+
+    unsigned int gen = ++rs->gen;
+    int fired = 0;
+
+    for (int i = 0; i < count; ++i) procs[i].alert = 0;
+
+    for (int k = 0; k < rs->rule_count; ++k) {
+        const watch_rule_t *r = &rs->rules[k];
+        watch_state_t *st = &states[k];
+
+        if (r->has_count) {
+            /* Condition sur l'onglet entier */
+            int matches = 0;
+            for (int i = 0; i < count; ++i) {
+                if (filter_match(&r->filter, &procs[i])) matches++;
+            }
+
+            if (!filter_cmp_num((double)matches, r->count_op, r->count_value)) {
+                st->since = -1.0;
+                st->fired = 0;
+                continue;
+            }
+            if (st->since < 0.0) st->since = now;
+            if (now - st->since < r->for_sec) continue;
+
+            if (!st->fired) {
+                st->fired = 1;
+                fired = fire(rs, r, host, NULL, matches, fired, msg, msg_size);
+            }
+            for (int i = 0; i < count; ++i) {
+                if (!procs[i].alert && filter_match(&r->filter, &procs[i])) procs[i].alert = 1;
+            }
+            continue;
+        }
+
+        /* Condition par ligne, suivie par PID pour "for" et les transitions */
+        size_t live = 0;
+        for (int i = 0; i < count; ++i) {
+            if (!filter_match(&r->filter, &procs[i])) continue;
+
+            watch_entry_t *e = state_get(st, procs[i].pid);
+            if (!e) break;
+            if (e->gen != gen) live++;
+            e->gen = gen;
+            if (e->since < 0.0) e->since = now;
+            if (now - e->since < r->for_sec) continue;
+
+            procs[i].alert = 1;
+            if (!e->fired) {
+                e->fired = 1;
+                fired = fire(rs, r, host, &procs[i], 1, fired, msg, msg_size);
+            }
+        }
+        state_sweep(st, gen, live);
+    }
+
+    return fired;
+}
@@ -0,0 +1,39 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include <stddef.h>
+#include "process.h"
+
+/*
+ * Règles de surveillance, une par ligne ('#' pour les commentaires) :
+ *
+ *   cpu>90 for 30s
+ *   state==Z count>10
+ *   command~"java" mem>40 exec "logger -t pm java uses $WATCH_PID"
+ *
+ * Le reste de la ligne est une expression de filtre (voir filter.h ; termes
+ * sans espaces internes, juxtaposés = ET). "count>N" porte sur le nombre de lignes de l'onglet
+ * qui les vérifient, "for D" (s, m, h) exige que la condition dure, "exec"
+ * lance une commande (variables WATCH_RULE, WATCH_HOST, WATCH_PID) quand
+ * la règle se déclenche.
+ */
+
+typedef struct rules rules_t;
+
+/* Retourne NULL et affiche la ligne fautive si le fichier est invalide */
+rules_t *rules_load(const char *path);
+void rules_free(rules_t *rs);
+
+int rules_count(const rules_t *rs);
+
+/* Désactive les commandes "exec" (relecture d'un enregistrement) */
+void rules_set_exec(rules_t *rs, int enabled);
+
+/* Évalue toutes les règles sur le snapshot d'un onglet, à la date now
+ * (secondes). Le champ alert des lignes concernées par une règle
+ * déclenchée passe à 1. Retourne le nombre de nouveaux déclenchements ;
+ * le premier est décrit dans msg. */
+int rules_eval(rules_t *rs, int tab, const char *host, double now,
+               process_info_t *procs, int count, char *msg, size_t msg_size);
+
+#endif
@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sched.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+/* Lissage exponentiel des mesures */
+#define SCHED_ALPHA 0.3
+
+typedef struct {
+    long long last_ms;          /* fin de la dernière collecte, 0 = jamais */
+    int busy;                   /* collecte en cours */
+    int disabled;               /* onglet calculé (All hosts) */
+    int requested;
+    double cost_ms;             /* CPU par collecte, < 0 = pas encore mesuré */
+    double churn;               /* part des PIDs apparus / disparus */
+    int interval_ms;
+    int *pids;                  /* PIDs triés du dernier snapshot complet */
+    int pid_count;
+} sched_tab_t;
+
+struct sched {
+    sched_tab_t *tabs;
+    int tab_count;
+    int interval_ms;
+    double budget;              /* fraction d'un cœur */
+};
+
+sched_t *sched_new(int tab_count, int interval_ms, double budget)
+{
+    sched_t *s = calloc(1, sizeof(sched_t));
+    if (!s) return NULL;
+    s->tabs = calloc((size_t)(tab_count > 0 ? tab_count : 1), sizeof(sched_tab_t));
+    if (!s->tabs) {
+        free(s);
+        return NULL;
+    }
+    s->tab_count = tab_count;
+    s->interval_ms = interval_ms;
+    s->budget = budget / 100.0;
+    for (int t = 0; t < tab_count; ++t) {
+        s->tabs[t].cost_ms = -1.0;
+        s->tabs[t].churn = 0.01;
+        s->tabs[t].interval_ms = interval_ms;
+    }
+    return s;
+}
+
+void sched_free(sched_t *s)
+{
+    if (!s) return;
+    for (int t = 0; t < s->tab_count; ++t) free(s->tabs[t].pids);
+    free(s->tabs);
+    free(s);
+}
+
+static double tv_ms(struct timeval tv)
+{
+    return (double)tv.tv_sec * 1000.0 + (double)tv.tv_usec / 1000.0;
+}
+
+double sched_cpu_ms(void)
+{
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    return tv_ms(self.ru_utime) + tv_ms(self.ru_stime) +
+           tv_ms(children.ru_utime) + tv_ms(children.ru_stime);
+}
+
+void sched_disable(sched_t *s, int tab)
+{
+    if (s && tab >= 0 && tab < s->tab_count) s->tabs[tab].disabled = 1;
+}
+
+void sched_started(sched_t *s, int tab)
+{
+    if (s && tab >= 0 && tab < s->tab_count) s->tabs[tab].busy = 1;
+}
+
+void sched_collected(sched_t *s, int tab, long long now_ms, double cpu_ms)
+{
+    if (!s || tab < 0 || tab >= s->tab_count) return;
+    sched_tab_t *st = &s->tabs[tab];
+    st->busy = 0;
+    st->requested = 0;
+    st->last_ms = now_ms;
+    if (cpu_ms >= 0.0) {
+        st->cost_ms = st->cost_ms < 0.0 ? cpu_ms
+                                        : st->cost_ms + SCHED_ALPHA * (cpu_ms - st->cost_ms);
+    }
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+void sched_observe(sched_t *s, int tab, const process_info_t *rows, int count)
+{
+    if (!s || tab < 0 || tab >= s->tab_count) return;
+
+    int *cur = malloc((size_t)(count + 1) * sizeof(int));
+    if (!cur) return;
+    for (int i = 0; i < count; ++i) cur[i] = rows[i].pid;
+    qsort(cur, (size_t)count, sizeof(int), compare_int);
+
+    sched_tab_t *st = &s->tabs[tab];
+    const int *old = st->pids;
+    int old_count = st->pid_count;
+    if (old) {
+        /* PIDs présents d'un seul côté */
+        int i = 0, j = 0, diff = 0;
+        while (i < old_count || j < count) {
+            if (j >= count || (i < old_count && old[i] < cur[j]))    { diff++; i++; }
+            else if (i >= old_count || cur[j] < old[i])              { diff++; j++; }
+            else                                                     { i++; j++; }
+        }
+        int n = old_count > count ? old_count : count;
+        double churn = n > 0 ? (double)diff / (double)n : 0.0;
+        st->churn += SCHED_ALPHA * (churn - st->churn);
+    }
+    free(st->pids);
+    st->pids = cur;
+    st->pid_count = count;
+}
+
+void sched_request(sched_t *s)
+{
+    for (int t = 0; s && t < s->tab_count; ++t) s->tabs[t].requested = 1;
+}
+
+static int clamp_ms(double v)
+{
+    if (v < SCHED_MIN_MS) return SCHED_MIN_MS;
+    if (v > SCHED_MAX_MS) return SCHED_MAX_MS;
+    return (int)v;
+}
+
+/* Intervalles voulus, puis étirés pour tenir le budget CPU */
+static void compute_intervals(sched_t *s, int visible)
+{
+    double load_vis = 0.0, load_bg = 0.0;
+
+    for (int t = 0; t < s->tab_count; ++t) {
+        sched_tab_t *st = &s->tabs[t];
+        if (st->disabled) continue;
+        int vis = (visible == SCHED_ALL_VISIBLE || t == visible);
+        double base = (double)s->interval_ms * (vis ? 1 : SCHED_BACKGROUND_FACTOR);
+
+        /* churn 1 % -> x1, stable -> x2, >= 3 % -> x0.5 */
+        double f = 0.02 / (st->churn + 0.01);
+        if (f < 0.5) f = 0.5;
+        if (f > 2.0) f = 2.0;
+        st->interval_ms = clamp_ms(base * f);
+
+        double load = st->cost_ms > 0.0 ? st->cost_ms / st->interval_ms : 0.0;
+        if (vis) load_vis += load;
+        else     load_bg += load;
+    }
+
+    if (s->budget <= 0.0 || load_vis + load_bg <= s->budget) return;
+
+    /* Arrière-plan d'abord ; si l'onglet affiché dépasse seul, tout ralentit */
+    double scale_bg, scale_vis = 1.0;
+    if (load_vis < s->budget) {
+        scale_bg = load_bg / (s->budget - load_vis);
+    } else {
+        scale_vis = (load_vis + load_bg) / s->budget;
+        scale_bg = scale_vis;
+    }
+    for (int t = 0; t < s->tab_count; ++t) {
+        sched_tab_t *st = &s->tabs[t];
+        int vis = (visible == SCHED_ALL_VISIBLE || t == visible);
+        st->interval_ms = clamp_ms(st->interval_ms * (vis ? scale_vis : scale_bg));
+    }
+}
+
+int sched_next_due(sched_t *s, long long now_ms, int visible)
+{
+    if (!s || s->interval_ms <= 0) return -1;
+    compute_intervals(s, visible);
+
+    int best = -1;
+    long long best_late = 0;
+    for (int t = 0; t < s->tab_count; ++t) {
+        const sched_tab_t *st = &s->tabs[t];
+        if (st->busy || st->disabled) continue;
+
+        long long due = st->last_ms + (st->requested ? SCHED_MIN_MS : st->interval_ms);
+        if (st->last_ms == 0) due = now_ms;
+        if (due > now_ms) continue;
+
+        /* Le plus en retard d'abord, l'onglet affiché en cas d'égalité */
+        long long late = now_ms - due;
+        if (best < 0 || late > best_late || (late == best_late && t == visible)) {
+            best = t;
+            best_late = late;
+        }
+    }
+    return best;
+}
+
+int sched_interval(const sched_t *s, int tab)
+{
+    if (!s || tab < 0 || tab >= s->tab_count) return 0;
+    return s->tabs[tab].interval_ms;
+}
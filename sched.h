@@ -0,0 +1,56 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "process.h"
+
+/*
+ * Rafraîchissement automatique des onglets : l'onglet affiché au rythme
+ * de base, les autres SCHED_BACKGROUND_FACTOR fois moins souvent.
+ * L'intervalle de chaque hôte est raccourci quand ses processus changent
+ * beaucoup (churn), allongé quand ils sont stables, puis l'ensemble est
+ * étiré pour que le CPU de collecte (le nôtre et celui des ssh) reste
+ * sous le budget, les onglets en arrière-plan d'abord.
+ */
+
+#define SCHED_DEFAULT_INTERVAL_MS 1000
+#define SCHED_DEFAULT_BUDGET      5.0   /* % d'un cœur */
+#define SCHED_BACKGROUND_FACTOR   5
+#define SCHED_MIN_MS              500
+#define SCHED_MAX_MS              60000
+
+/* Onglet affiché : aucun en particulier (démon), tous au rythme de base */
+#define SCHED_ALL_VISIBLE (-1)
+
+typedef struct sched sched_t;
+
+/* interval_ms : rythme de l'onglet affiché ; budget : % d'un cœur */
+sched_t *sched_new(int tab_count, int interval_ms, double budget);
+void sched_free(sched_t *s);
+
+/* Onglet jamais collecté (All hosts, recalculé à partir des autres) */
+void sched_disable(sched_t *s, int tab);
+
+/* CPU consommé par le processus et ses enfants attendus, en ms */
+double sched_cpu_ms(void);
+
+/* Collecte lancée (distants : fetch asynchrone en cours) */
+void sched_started(sched_t *s, int tab);
+
+/* Collecte terminée, cpu_ms : coût mesuré (< 0 si inconnu) */
+void sched_collected(sched_t *s, int tab, long long now_ms, double cpu_ms);
+
+/* Snapshot complet de l'onglet, avant tout filtre : le churn est estimé
+ * par rapport au précédent, gardé ici */
+void sched_observe(sched_t *s, int tab, const process_info_t *rows, int count);
+
+/* Demande de rafraîchissement (lecteur du démon) : tous les onglets
+ * repassent dès que SCHED_MIN_MS s'est écoulé depuis leur collecte */
+void sched_request(sched_t *s);
+
+/* Prochain onglet à rafraîchir, -1 si aucun n'est dû */
+int sched_next_due(sched_t *s, long long now_ms, int visible);
+
+/* Intervalle courant d'un onglet (affichage), 0 si inconnu */
+int sched_interval(const sched_t *s, int tab);
+
+#endif
@@ -0,0 +1,232 @@
+#define _POSIX_C_SOURCE 200809L
+#include "shm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+void shm_default_name(char *buf, size_t size)
+{
+    snprintf(buf, size, "/process_manager-%u", (unsigned)getuid());
+}
+
+/* --- Écriture --- */
+
+struct shm_writer {
+    int fd;
+    char name[64];
+    unsigned char *map;
+    size_t map_len;
+    size_t slot_cap[2];             /* lignes que peut recevoir chaque emplacement */
+};
+
+static shm_header_t *writer_header(const shm_writer_t *w)
+{
+    return (shm_header_t *)w->map;
+}
+
+shm_writer_t *shm_publish_open(const char *name, const char *host)
+{
+    shm_writer_t *w = calloc(1, sizeof(shm_writer_t));
+    if (!w) {
+        perror("calloc shm");
+        return NULL;
+    }
+    snprintf(w->name, sizeof(w->name), "%s", name);
+
+    /* Segment neuf : un lecteur de l'ancien garde sa projection */
+    shm_unlink(name);
+    w->fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    w->map_len = sizeof(shm_header_t);
+    if (w->fd < 0 || ftruncate(w->fd, (off_t)w->map_len) != 0) {
+        perror(name);
+        if (w->fd >= 0) close(w->fd);
+        free(w);
+        return NULL;
+    }
+    w->map = mmap(NULL, w->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, w->fd, 0);
+    if (w->map == MAP_FAILED) {
+        perror("mmap shm");
+        close(w->fd);
+        shm_unlink(name);
+        free(w);
+        return NULL;
+    }
+
+    shm_header_t *h = writer_header(w);
+    memset(h, 0, sizeof(*h));
+    h->version = SHM_VERSION;
+    h->row_size = (unsigned)sizeof(process_info_t);
+    if (host) snprintf(h->host, sizeof(h->host), "%s", host);
+    else      gethostname(h->host, sizeof(h->host) - 1);
+    atomic_store_explicit(&h->size, w->map_len, memory_order_relaxed);
+    atomic_store_explicit(&h->seq, 0, memory_order_relaxed);
+    /* Le magic en dernier : un lecteur n'accepte qu'un entête complet */
+    atomic_thread_fence(memory_order_release);
+    h->magic = SHM_MAGIC;
+    return w;
+}
+
+/* Nouvelle zone en fin de segment pour l'emplacement slot. L'ancienne
+ * est abandonnée : l'autre emplacement, peut-être en cours de lecture,
+ * n'est jamais déplacé ni recouvert. */
+static int grow_slot(shm_writer_t *w, int slot, int count)
+{
+    size_t cap = w->slot_cap[slot] ? w->slot_cap[slot] : 256;
+    while (cap < (size_t)count) cap *= 2;
+
+    size_t offset = w->map_len;
+    size_t len = offset + cap * sizeof(process_info_t);
+    if (ftruncate(w->fd, (off_t)len) != 0) {
+        perror("ftruncate shm");
+        return -1;
+    }
+    unsigned char *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, w->fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap shm");
+        return -1;
+    }
+    munmap(w->map, w->map_len);
+    w->map = map;
+    w->map_len = len;
+    w->slot_cap[slot] = cap;
+
+    shm_header_t *h = writer_header(w);
+    h->slots[slot].offset = offset;
+    atomic_store_explicit(&h->size, len, memory_order_release);
+    return 0;
+}
+
+int shm_publish(shm_writer_t *w, long long ts_ms, const process_info_t *rows, int count)
+{
+    if (!w) return -1;
+    shm_header_t *h = writer_header(w);
+
+    /* Emplacement non publié ; seq impair pendant qu'on le remplit */
+    unsigned long long seq = atomic_load_explicit(&h->seq, memory_order_relaxed);
+    int slot = (int)(((seq >> 1) + 1) & 1);
+    atomic_store_explicit(&h->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if ((size_t)count > w->slot_cap[slot] && grow_slot(w, slot, count) != 0) {
+        atomic_store_explicit(&h->seq, seq + 2, memory_order_release);
+        return -1;
+    }
+    h = writer_header(w);
+
+    shm_slot_t *s = &h->slots[slot];
+    if (count > 0) memcpy(w->map + s->offset, rows, (size_t)count * sizeof(process_info_t));
+    s->count = count;
+    s->ts_ms = ts_ms;
+
+    atomic_store_explicit(&h->seq, seq + 2, memory_order_release);
+    return 0;
+}
+
+void shm_publish_close(shm_writer_t *w)
+{
+    if (!w) return;
+    munmap(w->map, w->map_len);
+    close(w->fd);
+    shm_unlink(w->name);
+    free(w);
+}
+
+/* --- Lecture --- */
+
+struct shm_reader {
+    int fd;
+    const unsigned char *map;
+    size_t map_len;
+};
+
+static int reader_map(shm_reader_t *r, size_t len)
+{
+    const unsigned char *map = mmap(NULL, len, PROT_READ, MAP_SHARED, r->fd, 0);
+    if (map == MAP_FAILED) return -1;
+    if (r->map) munmap((void *)r->map, r->map_len);
+    r->map = map;
+    r->map_len = len;
+    return 0;
+}
+
+shm_reader_t *shm_reader_open(const char *name)
+{
+    char def[64];
+    if (!name) {
+        shm_default_name(def, sizeof(def));
+        name = def;
+    }
+
+    shm_reader_t *r = calloc(1, sizeof(shm_reader_t));
+    if (!r) return NULL;
+    r->fd = shm_open(name, O_RDONLY, 0);
+    struct stat st;
+    if (r->fd < 0 || fstat(r->fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_header_t) ||
+        reader_map(r, (size_t)st.st_size) != 0) {
+        shm_reader_close(r);
+        return NULL;
+    }
+
+    const shm_header_t *h = (const shm_header_t *)r->map;
+    if (h->magic != SHM_MAGIC || h->version != SHM_VERSION ||
+        h->row_size != sizeof(process_info_t)) {
+        fprintf(stderr, "%s: incompatible snapshot segment\n", name);
+        shm_reader_close(r);
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return r;
+}
+
+void shm_reader_close(shm_reader_t *r)
+{
+    if (!r) return;
+    if (r->map) munmap((void *)r->map, r->map_len);
+    if (r->fd >= 0) close(r->fd);
+    free(r);
+}
+
+unsigned long long shm_read_begin(shm_reader_t *r, shm_snapshot_t *out)
+{
+    out->rows = NULL;
+    out->count = 0;
+    out->ts_ms = 0;
+
+    const shm_header_t *h = (const shm_header_t *)r->map;
+    unsigned long long seq = atomic_load_explicit(&((shm_header_t *)h)->seq, memory_order_acquire);
+
+    /* Le segment a grandi : seul cas avec un appel système */
+    size_t size = atomic_load_explicit(&((shm_header_t *)h)->size, memory_order_acquire);
+    if (size > r->map_len) {
+        if (reader_map(r, size) != 0) return seq;
+        h = (const shm_header_t *)r->map;
+    }
+
+    const shm_slot_t *s = &h->slots[(seq >> 1) & 1];
+    unsigned long long offset = s->offset;
+    int count = s->count;
+    if (count < 0 || offset > r->map_len ||
+        (unsigned long long)count > (r->map_len - offset) / sizeof(process_info_t)) {
+        /* Descripteur en cours de mise à jour : shm_read_valid() échouera */
+        return seq;
+    }
+    out->rows = (const process_info_t *)(r->map + offset);
+    out->count = count;
+    out->ts_ms = s->ts_ms;
+    return seq;
+}
+
+int shm_read_valid(const shm_reader_t *r, unsigned long long ticket)
+{
+    /* L'emplacement lu n'est réécrit qu'à partir de la publication
+     * suivant la prochaine, quand seq atteint 2k + 3 */
+    atomic_thread_fence(memory_order_acquire);
+    const shm_header_t *h = (const shm_header_t *)r->map;
+    unsigned long long now = atomic_load_explicit(&((shm_header_t *)h)->seq, memory_order_relaxed);
+    return now < (ticket | 1) + 2;
+}
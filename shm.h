@@ -0,0 +1,82 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "process.h"
+
+/*
+ * Publication du dernier snapshot local dans un segment de mémoire
+ * partagée POSIX (--shm), pour les outils de la même machine.
+ *
+ * Deux emplacements alternés et un compteur de séquence : l'écrivain
+ * remplit l'emplacement non publié (seq impair pendant l'écriture) puis
+ * le publie (seq pair). Un lecteur lit sans copie ni appel système, puis
+ * vérifie avec shm_read_valid() que son emplacement n'a pas été réécrit :
+ * il dispose d'un intervalle de publication complet pour le parcourir.
+ *
+ *   shm_reader_t *r = shm_reader_open(NULL);
+ *   shm_snapshot_t snap;
+ *   unsigned long long ticket;
+ *   do {
+ *       ticket = shm_read_begin(r, &snap);
+ *       ... parcourir snap.rows[0 .. snap.count) ...
+ *   } while (!shm_read_valid(r, ticket));
+ */
+
+#define SHM_MAGIC   0x4d484d50u     /* "PMHM" */
+#define SHM_VERSION 1
+
+typedef struct {
+    unsigned long long offset;      /* depuis le début du segment */
+    int count;
+    int reserved;
+    long long ts_ms;
+} shm_slot_t;
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int row_size;          /* sizeof(process_info_t) de l'écrivain */
+    unsigned int reserved;
+    _Atomic unsigned long long seq;
+    _Atomic unsigned long long size;    /* taille du segment, ne fait que croître */
+    shm_slot_t slots[2];
+    char host[64];
+} shm_header_t;
+
+typedef struct {
+    const process_info_t *rows;     /* dans le segment, valide jusqu'à shm_read_valid() */
+    int count;
+    long long ts_ms;
+} shm_snapshot_t;
+
+/* "/process_manager-UID" */
+void shm_default_name(char *buf, size_t size);
+
+/* --- Écriture (collecteur) --- */
+
+typedef struct shm_writer shm_writer_t;
+
+/* host NULL : nom de la machine */
+shm_writer_t *shm_publish_open(const char *name, const char *host);
+int shm_publish(shm_writer_t *w, long long ts_ms, const process_info_t *rows, int count);
+
+/* Supprime le segment : les lecteurs gardent leur projection */
+void shm_publish_close(shm_writer_t *w);
+
+/* --- Lecture --- */
+
+typedef struct shm_reader shm_reader_t;
+
+/* name NULL : nom par défaut. NULL si aucun collecteur ne publie. */
+shm_reader_t *shm_reader_open(const char *name);
+void shm_reader_close(shm_reader_t *r);
+
+/* Début de lecture ; retourne le ticket à passer à shm_read_valid() */
+unsigned long long shm_read_begin(shm_reader_t *r, shm_snapshot_t *out);
+
+/* 1 si les lignes lues depuis shm_read_begin() sont cohérentes */
+int shm_read_valid(const shm_reader_t *r, unsigned long long ticket);
+
+#endif
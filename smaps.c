@@ -0,0 +1,188 @@
+#define _POSIX_C_SOURCE 200809L
+#include "smaps.h"
+#include "clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int pid;                    /* 0 = emplacement libre */
+    int valid;                  /* dernière lecture réussie */
+    long long start_time;       /* du processus lu, 0 = inconnu */
+    unsigned long long pss_kb;
+    unsigned long long uss_kb;
+    unsigned long long swap_kb;
+    double read_at;             /* 0 = jamais lu */
+    double wanted_at;
+    double urgent_at;
+    double cost_ms;             /* durée de la dernière lecture */
+} smaps_entry_t;
+
+/* Table à adressage ouvert indexée par PID ; reconstruite pour oublier
+ * les entrées, ce qui évite les marques de suppression */
+struct smaps_cache {
+    smaps_entry_t *slots;
+    size_t cap;                 /* puissance de 2 */
+    size_t count;
+    double pruned_at;
+    smaps_entry_t **due;        /* candidats d'une relecture */
+    size_t due_cap;
+};
+
+static size_t slot_of(const smaps_cache_t *c, int pid)
+{
+    size_t mask = c->cap - 1;
+    size_t i = ((unsigned)pid * 2654435761U) & mask;
+    while (c->slots[i].pid != 0 && c->slots[i].pid != pid) i = (i + 1) & mask;
+    return i;
+}
+
+/* Nouvelle table de cap emplacements, avec les entrées encore demandées */
+static int rebuild(smaps_cache_t *c, size_t cap, double forget_before)
+{
+    smaps_entry_t *slots = calloc(cap, sizeof(smaps_entry_t));
+    if (!slots) {
+        perror("calloc smaps cache");
+        return -1;
+    }
+
+    smaps_entry_t *old = c->slots;
+    size_t old_cap = c->cap;
+    c->slots = slots;
+    c->cap = cap;
+    c->count = 0;
+    for (size_t i = 0; i < old_cap; ++i) {
+        if (old[i].pid == 0 || old[i].wanted_at < forget_before) continue;
+        c->slots[slot_of(c, old[i].pid)] = old[i];
+        c->count++;
+    }
+    free(old);
+    return 0;
+}
+
+smaps_cache_t *smaps_cache_new(void)
+{
+    smaps_cache_t *c = calloc(1, sizeof(smaps_cache_t));
+    if (!c) {
+        perror("calloc smaps cache");
+        return NULL;
+    }
+    if (rebuild(c, 256, 0.0) != 0) {
+        free(c);
+        return NULL;
+    }
+    c->pruned_at = now_seconds();
+    return c;
+}
+
+void smaps_cache_free(smaps_cache_t *c)
+{
+    if (!c) return;
+    free(c->slots);
+    free(c->due);
+    free(c);
+}
+
+void smaps_cache_fill(smaps_cache_t *c, process_info_t *p, int urgent)
+{
+    if (!c || p->pid <= 0) return;
+
+    /* Charge au plus 1/2 */
+    if ((c->count + 1) * 2 > c->cap && rebuild(c, c->cap * 2, 0.0) != 0) return;
+
+    smaps_entry_t *e = &c->slots[slot_of(c, p->pid)];
+    if (e->pid == 0) {
+        memset(e, 0, sizeof(*e));
+        e->pid = p->pid;
+        c->count++;
+    }
+
+    /* PID réutilisé : les valeurs sont celles de l'ancien processus.
+     * start_time est déduit de l'uptime, à une ou deux secondes près */
+    if (p->filled & PROC_NEED_STAT) {
+        if (e->start_time != 0 && llabs(e->start_time - p->start_time) > SMAPS_START_SLACK_S) {
+            int pid = e->pid;
+            memset(e, 0, sizeof(*e));
+            e->pid = pid;
+        }
+        e->start_time = p->start_time;
+    }
+
+    double now = now_seconds();
+    e->wanted_at = now;
+    if (urgent) e->urgent_at = now;
+
+    if (e->valid) {
+        p->pss_kb = e->pss_kb;
+        p->uss_kb = e->uss_kb;
+        p->swap_kb = e->swap_kb;
+        p->filled |= PROC_NEED_SMAPS;
+    }
+}
+
+/* Urgentes d'abord, puis les plus anciennes (jamais lues en tête) */
+static int compare_due(const void *a, const void *b)
+{
+    const smaps_entry_t *x = *(smaps_entry_t *const *)a;
+    const smaps_entry_t *y = *(smaps_entry_t *const *)b;
+    if (x->urgent_at != y->urgent_at) return x->urgent_at > y->urgent_at ? -1 : 1;
+    if (x->read_at != y->read_at) return x->read_at < y->read_at ? -1 : 1;
+    return 0;
+}
+
+int smaps_cache_refresh(smaps_cache_t *c, double budget_ms)
+{
+    if (!c || c->count == 0) return 0;
+
+    double now = now_seconds();
+    if (now - c->pruned_at > 1.0) {
+        c->pruned_at = now;
+        rebuild(c, c->cap, now - SMAPS_FORGET_S);
+    }
+
+    if (c->due_cap < c->count) {
+        smaps_entry_t **tmp = realloc(c->due, c->cap * sizeof(smaps_entry_t *));
+        if (!tmp) return 0;
+        c->due = tmp;
+        c->due_cap = c->cap;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < c->cap; ++i) {
+        smaps_entry_t *e = &c->slots[i];
+        if (e->pid == 0 || now - e->wanted_at > SMAPS_WANT_S) continue;
+        /* Urgence passée : même rang que les autres */
+        if (now - e->urgent_at > SMAPS_WANT_S) e->urgent_at = 0.0;
+        double max_age = SMAPS_MAX_AGE_S + e->cost_ms * SMAPS_AGE_PER_MS;
+        if (e->read_at == 0.0 || now - e->read_at > max_age) c->due[n++] = e;
+    }
+    if (n == 0) return 0;
+    qsort(c->due, n, sizeof(smaps_entry_t *), compare_due);
+
+    /* Au moins une lecture par appel, même si elle dépasse le budget */
+    double spent = 0.0;
+    int reads = 0;
+    for (size_t k = 0; k < n && (reads == 0 || spent < budget_ms); ++k) {
+        smaps_entry_t *e = c->due[k];
+        process_info_t tmp;
+        memset(&tmp, 0, sizeof(tmp));
+        tmp.pid = e->pid;
+
+        double t0 = now_seconds();
+        process_fill_extra(&tmp, PROC_NEED_SMAPS);
+        double t1 = now_seconds();
+
+        /* Processus terminé ou d'un autre utilisateur : "-" jusqu'à la
+         * prochaine tentative */
+        e->valid = (tmp.filled & PROC_NEED_SMAPS) != 0;
+        e->pss_kb = tmp.pss_kb;
+        e->uss_kb = tmp.uss_kb;
+        e->swap_kb = tmp.swap_kb;
+        e->read_at = t1;
+        e->cost_ms = (t1 - t0) * 1000.0;
+        spent += e->cost_ms;
+        reads++;
+    }
+    return reads;
+}
@@ -0,0 +1,38 @@
+#ifndef SMAPS_H
+#define SMAPS_H
+
+#include "process.h"
+
+/*
+ * Mémoire détaillée (PSS, USS, swap) de /proc/<pid>/smaps_rollup, pour les
+ * seuls processus qui la demandent : lignes affichées, ou tout l'onglet
+ * local pour le tri sort=pss.
+ *
+ * Le noyau parcourt l'espace d'adressage à chaque lecture : les valeurs
+ * sont gardées par PID et relues en tâche de fond, dans un budget de
+ * temps par tour de boucle. Un processus dont la lecture est longue est
+ * relu moins souvent. L'affichage et le tri n'utilisent que le cache.
+ */
+
+#define SMAPS_MAX_AGE_S     5.0     /* âge minimal avant relecture */
+#define SMAPS_AGE_PER_MS    0.5     /* + 0,5 s d'âge par ms de lecture */
+#define SMAPS_WANT_S        2.0     /* entrée plus demandée : plus relue */
+#define SMAPS_FORGET_S      30.0    /* entrée plus demandée : oubliée */
+#define SMAPS_TICK_BUDGET_MS 10.0   /* lecture par tour de la boucle principale */
+#define SMAPS_START_SLACK_S 2      /* écart de start_time toléré pour un même PID */
+
+typedef struct smaps_cache smaps_cache_t;
+
+smaps_cache_t *smaps_cache_new(void);
+void smaps_cache_free(smaps_cache_t *c);
+
+/* Copie dans p les valeurs en cache (PROC_NEED_SMAPS dans filled) et
+ * demande leur mise à jour. urgent : ligne affichée, relue avant les
+ * autres. Ne lit jamais /proc. */
+void smaps_cache_fill(smaps_cache_t *c, process_info_t *p, int urgent);
+
+/* Relit les entrées demandées et périmées, urgentes d'abord puis les plus
+ * anciennes, jusqu'à budget_ms. Retourne le nombre de lectures. */
+int smaps_cache_refresh(smaps_cache_t *c, double budget_ms);
+
+#endif
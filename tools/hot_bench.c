@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200809L
+/*
+ * Durée des noyaux de hot.c sur des colonnes synthétiques (make bench).
+ *
+ *   hot_bench [-n LIGNES] [-k K]
+ *
+ * %CPU comme sur un hôte réel : la plupart des lignes à 0, quelques
+ * valeurs arrondies au centième, donc beaucoup d'égalités. Vérifie aussi
+ * que hot_topk() donne les K premières lignes de hot_sort_desc(), pid
+ * dans l'ordre puis mélangés.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../clock.h"
+#include "../filter.h"
+#include "../hot.h"
+
+#define BENCH_RUNS 5
+
+static unsigned long long rng_state = 1;
+
+static unsigned long long rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Meilleure durée (ms) de call, répété loops fois par passage */
+#define BEST_MS(best, loops, call)                                      \
+    do {                                                                \
+        best = 0.0;                                                     \
+        for (int run_ = 0; run_ < BENCH_RUNS; ++run_) {                 \
+            double t0_ = now_seconds();                                 \
+            for (int l_ = 0; l_ < (loops); ++l_) { call; }              \
+            double dt_ = (now_seconds() - t0_) / (loops) * 1e3;         \
+            if (best == 0.0 || dt_ < best) best = dt_;                  \
+        }                                                               \
+    } while (0)
+
+/* 0 si topk est le début de sorted */
+static int check_topk(const double *cpu, const int *pid, int n, int k, int *topk, int *sorted)
+{
+    int r = hot_topk(cpu, pid, n, k, topk);
+    if (hot_sort_desc(cpu, pid, n, sorted) != n) return -1;
+    return memcmp(topk, sorted, (size_t)r * sizeof(int)) != 0;
+}
+
+int main(int argc, char **argv)
+{
+    int n = 300000, k = 100;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-n") == 0) n = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-k") == 0) k = atoi(argv[i + 1]);
+    }
+    if (n <= 0 || k <= 0 || k > n) {
+        fprintf(stderr, "usage: %s [-n ROWS] [-k K]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    double *cpu = malloc((size_t)n * sizeof(double));
+    int *pid = malloc((size_t)n * sizeof(int));
+    int *out = malloc((size_t)n * sizeof(int));
+    int *sorted = malloc((size_t)n * sizeof(int));
+    if (!cpu || !pid || !out || !sorted) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < n; ++i) {
+        unsigned long long r = rng();
+        cpu[i] = (r % 10 == 0) ? (double)(r % 10000) / 100.0 : 0.0;
+        pid[i] = i + 1;
+    }
+
+    double sum_ms, select_ms, topk_ms, sort_ms, shuffled_ms;
+    volatile double sink = 0.0;
+    int loops = 3000000 / n + 1;
+    BEST_MS(sum_ms, loops, sink += hot_sum(cpu, n));
+    BEST_MS(select_ms, loops, sink += hot_select(cpu, n, FO_GT, 1.0, out));
+    BEST_MS(topk_ms, loops, sink += hot_topk(cpu, pid, n, k, out));
+    BEST_MS(sort_ms, 1, sink += hot_sort_desc(cpu, pid, n, out));
+    if (check_topk(cpu, pid, n, k, out, sorted) != 0) {
+        fprintf(stderr, "top-%d differs from the sort (pids in order)\n", k);
+        return EXIT_FAILURE;
+    }
+
+    /* Lignes qui ne sont plus dans l'ordre des pid (hôte distant, fusion) */
+    for (int i = n - 1; i > 0; --i) {
+        int j = (int)(rng() % (unsigned long long)(i + 1));
+        int t = pid[i];
+        pid[i] = pid[j];
+        pid[j] = t;
+    }
+    BEST_MS(shuffled_ms, 1, sink += hot_sort_desc(cpu, pid, n, out));
+    if (check_topk(cpu, pid, n, k, out, sorted) != 0) {
+        fprintf(stderr, "top-%d differs from the sort (shuffled pids)\n", k);
+        return EXIT_FAILURE;
+    }
+
+    printf("%d rows: sum %.3f ms, select %.3f ms, top-%d %.3f ms, "
+           "sort %.2f ms (%.2f ms shuffled pids), best of %d runs\n",
+           n, sum_ms, select_ms, k, topk_ms, sort_ms, shuffled_ms, BENCH_RUNS);
+    free(cpu);
+    free(pid);
+    free(out);
+    free(sorted);
+    return EXIT_SUCCESS;
+}
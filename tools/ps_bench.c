@@ -0,0 +1,100 @@
+#define _POSIX_C_SOURCE 200809L
+/*
+ * Débit de create_process_list_from_buffer() sur des sorties de ps
+ * enregistrées (make bench).
+ *
+ *   ps_bench [-m MO] FICHIER...
+ *
+ * Chaque fichier est un snapshot, analysé et libéré en boucle comme à
+ * chaque collecte d'un hôte, jusqu'à environ MO mégaoctets (64 par
+ * défaut) ; le meilleur de plusieurs passages est retenu. Un seul tampon
+ * géant mesurerait surtout les fautes de page de son pool de lignes
+ * (~700 octets par processus), pas l'analyse.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../clock.h"
+#include "../process.h"
+
+#define BENCH_RUNS 5
+
+/* Contenu du fichier, *len octets ; NULL en cas d'erreur */
+static char *read_file(const char *path, size_t *len)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror(path);
+        return NULL;
+    }
+    size_t cap = 64 * 1024, n;
+    char *buf = malloc(cap);
+    *len = 0;
+    while (buf && (n = fread(buf + *len, 1, cap - *len, fp)) > 0) {
+        *len += n;
+        if (*len == cap) {
+            char *tmp = realloc(buf, cap * 2);
+            if (!tmp) {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = tmp;
+            cap *= 2;
+        }
+    }
+    if (!buf) perror("malloc");
+    fclose(fp);
+    return buf;
+}
+
+int main(int argc, char **argv)
+{
+    size_t target = 64;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-m") == 0) {
+        target = (size_t)atol(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || target == 0) {
+        fprintf(stderr, "usage: %s [-m MB] FILE...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    target *= 1024 * 1024;
+
+    for (int i = first; i < argc; ++i) {
+        size_t len;
+        char *snapshot = read_file(argv[i], &len);
+        if (!snapshot) return EXIT_FAILURE;
+        if (len == 0) {
+            free(snapshot);
+            continue;
+        }
+
+        long count = 0;
+        size_t loops = target / len + 1;
+        double best = 0.0;
+        for (int run = 0; run < BENCH_RUNS; ++run) {
+            double t0 = now_seconds();
+            for (size_t k = 0; k < loops; ++k) {
+                process_list *list = create_process_list_from_buffer(snapshot, len);
+                if (!list) return EXIT_FAILURE;
+                if (k == 0) {
+                    count = 0;
+                    for (process_elem *e = list->head; e; e = e->next) count++;
+                }
+                free_process_list(list);
+            }
+            double dt = now_seconds() - t0;
+            if (best == 0.0 || dt < best) best = dt;
+        }
+
+        double mb = (double)len * (double)loops / 1e6;
+        printf("%s: %zu KB, %ld rows x %zu: best of %d runs %.1f ms, %.0f MB/s, %.1f M rows/s\n",
+               argv[i], len / 1024, count, loops, BENCH_RUNS, best * 1e3,
+               mb / best, (double)count * (double)loops / 1e6 / best);
+        free(snapshot);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+#define _POSIX_C_SOURCE 200809L
+/*
+ * Fuzz de create_process_list_from_buffer() (make fuzz, compilé avec
+ * ASan / UBSan).
+ *
+ *   ps_fuzz [-n ITERATIONS] [-s GRAINE] FICHIER...
+ *
+ * Chaque itération part d'une sortie de ps enregistrée, lui applique
+ * quelques mutations (octets changés, insérés, supprimés, blocs dupliqués,
+ * troncature) et l'analyse dans un tampon de la taille exacte, sans '\0'
+ * final : une lecture hors du tampon est signalée par ASan. Les lignes
+ * retenues doivent avoir des chaînes terminées. Une entrée fautive est
+ * écrite dans ps_fuzz_failure.txt.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../process.h"
+
+#define FUZZ_MAX_FILES 32
+
+typedef struct {
+    char *data;
+    size_t len;
+} sample_t;
+
+/* xorshift : même graine, mêmes entrées */
+static unsigned long long rng_state;
+
+static unsigned long long rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static size_t rng_below(size_t n)
+{
+    return n ? (size_t)(rng() % n) : 0;
+}
+
+static int read_sample(const char *path, sample_t *s)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    s->data = malloc(size > 0 ? (size_t)size : 1);
+    s->len = s->data ? fread(s->data, 1, (size_t)(size > 0 ? size : 0), fp) : 0;
+    fclose(fp);
+    if (!s->data) {
+        perror("malloc sample");
+        return -1;
+    }
+    return 0;
+}
+
+/* Octets qui changent le découpage des lignes et des champs */
+static char interesting_byte(void)
+{
+    static const char bytes[] = { ' ', '\t', '\n', '\r', '.', '-', '0', '9', '\0', 'e', (char)0xff };
+    return bytes[rng_below(sizeof(bytes))];
+}
+
+/* Une mutation de buf (len octets, cap alloués) ; retourne la nouvelle taille */
+static size_t mutate(char *buf, size_t len, size_t cap)
+{
+    size_t at = rng_below(len + 1);
+    switch (rng_below(6)) {
+    case 0:                                     /* octet remplacé */
+        if (len > 0) buf[rng_below(len)] = interesting_byte();
+        break;
+    case 1:                                     /* octet aléatoire */
+        if (len > 0) buf[rng_below(len)] = (char)rng();
+        break;
+    case 2: {                                   /* insertion */
+        size_t n = 1 + rng_below(8);
+        if (len + n > cap) break;
+        memmove(buf + at + n, buf + at, len - at);
+        for (size_t i = 0; i < n; ++i) buf[at + i] = interesting_byte();
+        len += n;
+        break;
+    }
+    case 3: {                                   /* suppression */
+        size_t n = rng_below(len - at + 1);
+        if (n > 64) n = 64;
+        memmove(buf + at, buf + at + n, len - at - n);
+        len -= n;
+        break;
+    }
+    case 4: {                                   /* bloc dupliqué (champ très long) */
+        char chunk[512];
+        if (len == 0) break;
+        size_t from = rng_below(len);
+        size_t n = 1 + rng_below(len - from);
+        if (n > sizeof(chunk)) n = sizeof(chunk);
+        if (len + n > cap) break;
+        memcpy(chunk, buf + from, n);
+        memmove(buf + at + n, buf + at, len - at);
+        memcpy(buf + at, chunk, n);
+        len += n;
+        break;
+    }
+    default:                                    /* troncature */
+        len = at;
+        break;
+    }
+    return len;
+}
+
+static int string_ok(const char *s, size_t size)
+{
+    return memchr(s, '\0', size) != NULL;
+}
+
+/* Vérifie la liste ; 0 si elle est cohérente */
+static int check_list(const process_list *list, const char *buf, size_t len)
+{
+    size_t lines = 1;
+    for (size_t i = 0; i < len; ++i) {
+        if (buf[i] == '\n') lines++;
+    }
+    size_t rows = 0;
+    for (const process_elem *e = list->head; e; e = e->next) {
+        const process_info_t *p = &e->process;
+        if (++rows > lines) return -1;
+        if (p->pid < 0) return -1;
+        if (!string_ok(p->user, sizeof(p->user)) || !string_ok(p->command, sizeof(p->command))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void save_failure(const char *buf, size_t len)
+{
+    FILE *fp = fopen("ps_fuzz_failure.txt", "wb");
+    if (!fp) return;
+    fwrite(buf, 1, len, fp);
+    fclose(fp);
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = 20000;
+    unsigned long long seed = 1;
+    sample_t samples[FUZZ_MAX_FILES];
+    int count = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (count < FUZZ_MAX_FILES) {
+            if (read_sample(argv[i], &samples[count]) != 0) return EXIT_FAILURE;
+            count++;
+        }
+    }
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [-n ITERATIONS] [-s SEED] FILE...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    rng_state = seed ? seed : 1;
+
+    size_t max_len = 0;
+    for (int i = 0; i < count; ++i) {
+        if (samples[i].len > max_len) max_len = samples[i].len;
+    }
+    size_t cap = max_len + 4096;
+    char *work = malloc(cap);
+    if (!work) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    long parsed_rows = 0;
+    for (long it = 0; it < iterations; ++it) {
+        const sample_t *s = &samples[rng_below((size_t)count)];
+        memcpy(work, s->data, s->len);
+        size_t len = s->len;
+        int rounds = 1 + (int)rng_below(8);
+        for (int r = 0; r < rounds; ++r) len = mutate(work, len, cap);
+
+        /* Tampon de la taille exacte : ASan voit tout dépassement */
+        char *input = malloc(len ? len : 1);
+        if (!input) {
+            perror("malloc input");
+            return EXIT_FAILURE;
+        }
+        memcpy(input, work, len);
+
+        process_list *list = create_process_list_from_buffer(input, len);
+        if (!list || check_list(list, input, len) != 0) {
+            fprintf(stderr, "iteration %ld (seed %llu): %s, input saved to ps_fuzz_failure.txt\n",
+                    it, seed, list ? "inconsistent rows" : "no list");
+            save_failure(input, len);
+            return EXIT_FAILURE;
+        }
+        for (const process_elem *e = list->head; e; e = e->next) parsed_rows++;
+        free_process_list(list);
+        free(input);
+    }
+
+    printf("%ld inputs from %d file(s), %ld rows parsed, no failure (seed %llu)\n",
+           iterations, count, parsed_rows, seed);
+    for (int i = 0; i < count; ++i) free(samples[i].data);
+    free(work);
+    return EXIT_SUCCESS;
+}
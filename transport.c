@@ -0,0 +1,545 @@
+#define _POSIX_C_SOURCE 200809L
+#include "transport.h"
+#include "hoststat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/socket.h>
+
+/* Fils dont la sortie standard est un tube non bloquant (*fd).
+ * Retourne 0 dans le fils, son pid dans le parent, -1 en cas d'erreur. */
+static pid_t start_child(int *fd)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        /* Enfant : stdout vers le tube, pas de stdin (ssh ne doit pas
+         * lire les touches destinées à l'UI) */
+        int devnull = open("/dev/null", O_RDONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDIN_FILENO);
+            close(devnull);
+        }
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        return 0;
+    }
+
+    close(fds[1]);
+    int flags = fcntl(fds[0], F_GETFL);
+    fcntl(fds[0], F_SETFL, flags | O_NONBLOCK);
+    *fd = fds[0];
+    return pid;
+}
+
+/* Lance "sh -c cmd" */
+static pid_t spawn_command(const char *cmd, int *fd)
+{
+    pid_t pid = start_child(fd);
+    if (pid == 0) {
+        execl("/bin/sh", "sh", "-c", cmd, (char *)NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+const char *transport_signal_name(int signum)
+{
+    switch (signum) {
+    case SIGSTOP: return "STOP";
+    case SIGTERM: return "TERM";
+    case SIGKILL: return "KILL";
+    case SIGCONT: return "CONT";
+    default:      return NULL;
+    }
+}
+
+/* --- Commandes shell (ssh, local) --- */
+
+/* "ssh <options> -p PORT [user@]host" */
+static void format_ssh_target(const remotemachine_t *m, char *buf, size_t size)
+{
+    if (m->username[0] != '\0') {
+        snprintf(buf, size,
+                 "ssh -o ConnectTimeout=%d -o BatchMode=yes -p %d %s@%s",
+                 NET_CONNECT_TIMEOUT, m->port, m->username, m->host);
+    } else {
+        snprintf(buf, size,
+                 "ssh -o ConnectTimeout=%d -o BatchMode=yes -p %d %s",
+                 NET_CONNECT_TIMEOUT, m->port, m->host);
+    }
+}
+
+/* Commande ps avec le filtre / tri / limite poussés côté hôte */
+static void build_ps_command(const process_query_t *q, char *buf, size_t size)
+{
+    size_t off = (size_t)snprintf(buf, size, "ps -eo pid,user,pcpu,pmem,stat,comm");
+
+    if (q && q->sort == PROC_SORT_CPU && off < size) {
+        off += (size_t)snprintf(buf + off, size - off, " --sort=-pcpu");
+    } else if (q && q->sort == PROC_SORT_MEM && off < size) {
+        off += (size_t)snprintf(buf + off, size - off, " --sort=-pmem");
+    }
+
+    /* Filtre traduit en awk, c = comm (qui peut contenir des espaces).
+     * La commande passe entre guillemets doubles par le shell local :
+     * $ et " sont échappés. */
+    const char *awk = (q && q->filter.code_len > 0) ? q->filter.awk : "";
+    if (awk[0] != '\0' && off < size) {
+        off += (size_t)snprintf(buf + off, size - off,
+                                " | awk '{c=\\$6; for (i = 7; i <= NF; i++) c = c \\\" \\\" \\$i}"
+                                " NR==1 || (");
+        for (const char *p = awk; *p && off + 2 < size; ++p) {
+            if (*p == '$' || *p == '"') buf[off++] = '\\';
+            buf[off++] = *p;
+        }
+        buf[off] = '\0';
+        if (off < size) off += (size_t)snprintf(buf + off, size - off, ")'");
+    }
+
+    /* La limite n'est poussée que si le filtre distant est exact et le
+     * tri faisable par ps (pas de PSS) */
+    int exact = !q || ((q->filter.code_len == 0 || awk[0] != '\0') && q->sort != PROC_SORT_PSS);
+    if (q && q->limit > 0 && exact && off < size) {
+        /* +1 pour l'entête */
+        snprintf(buf + off, size - off, " | head -n %d", q->limit + 1);
+    }
+}
+
+/* ps, le résumé de l'hôte et les tâches du processus déplié, en un
+ * script à passer entre guillemets doubles */
+static void build_collector_script(const remote_request_t *req, char *buf, size_t size)
+{
+    build_ps_command(req ? req->query : NULL, buf, size);
+
+    /* Résumé de l'hôte : quelques lignes de /proc, même connexion */
+    size_t len = strlen(buf);
+    snprintf(buf + len, size - len, "; echo " HOST_MARKER "; " HOST_SAMPLE_COMMAND);
+
+    if (req && req->thread_pid > 0) {
+        /* Les tâches du processus déplié suivent dans le même flux */
+        len = strlen(buf);
+        snprintf(buf + len, size - len,
+                 "; echo " THREADS_MARKER "; cat /proc/%d/task/*/stat",
+                 req->thread_pid);
+    }
+}
+
+/* Un kill par signal, suivi de son code ($? échappé pour le shell local) */
+static void build_signal_script(const remote_signal_t *sigs, int n, char *buf, size_t size)
+{
+    size_t off = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < n && off < size; ++i) {
+        const char *name = transport_signal_name(sigs[i].signum);
+        if (!name) continue;
+        off += (size_t)snprintf(buf + off, size - off,
+                                "kill -%s %d 2>/dev/null; echo @@rc %d \\$?; ",
+                                name, sigs[i].pid, sigs[i].id);
+    }
+}
+
+static pid_t ssh_run_collector(const remotemachine_t *m, const remote_request_t *req,
+                               int probe, int *fd)
+{
+    char target[320];
+    format_ssh_target(m, target, sizeof(target));
+
+    char cmd[2048];
+    if (probe) {
+        snprintf(cmd, sizeof(cmd), "%s true >/dev/null 2>&1", target);
+    } else {
+        char script[1536];
+        build_collector_script(req, script, sizeof(script));
+        snprintf(cmd, sizeof(cmd), "%s \"%s\" 2>/dev/null", target, script);
+    }
+    return spawn_command(cmd, fd);
+}
+
+static pid_t ssh_send_signals(const remotemachine_t *m, const remote_signal_t *sigs, int n,
+                              int *fd)
+{
+    char target[320];
+    format_ssh_target(m, target, sizeof(target));
+
+    char script[3072];
+    build_signal_script(sigs, n, script, sizeof(script));
+    char cmd[3584];
+    snprintf(cmd, sizeof(cmd), "%s \"%s\" 2>/dev/null", target, script);
+    return spawn_command(cmd, fd);
+}
+
+/* Mêmes scripts, exécutés par sh sur cette machine */
+static pid_t local_run_collector(const remotemachine_t *m, const remote_request_t *req,
+                                 int probe, int *fd)
+{
+    (void)m;
+    char cmd[2048];
+    if (probe) {
+        snprintf(cmd, sizeof(cmd), "true");
+    } else {
+        char script[1536];
+        build_collector_script(req, script, sizeof(script));
+        snprintf(cmd, sizeof(cmd), "sh -c \"%s\" 2>/dev/null", script);
+    }
+    return spawn_command(cmd, fd);
+}
+
+static pid_t local_send_signals(const remotemachine_t *m, const remote_signal_t *sigs, int n,
+                                int *fd)
+{
+    (void)m;
+    char script[3072];
+    build_signal_script(sigs, n, script, sizeof(script));
+    char cmd[3584];
+    snprintf(cmd, sizeof(cmd), "sh -c \"%s\" 2>/dev/null", script);
+    return spawn_command(cmd, fd);
+}
+
+/* Session ssh persistante : entrée et sortie sur une même socket, pas de
+ * shell local entre les deux (command n'est interprétée qu'à distance) */
+pid_t transport_open_stream(const remotemachine_t *m, const char *command, int *fd)
+{
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        perror("socketpair");
+        return -1;
+    }
+
+    char timeout[32], port[16], target[200];
+    snprintf(timeout, sizeof(timeout), "ConnectTimeout=%d", NET_CONNECT_TIMEOUT);
+    snprintf(port, sizeof(port), "%d", m->port);
+    if (m->username[0] != '\0') snprintf(target, sizeof(target), "%s@%s", m->username, m->host);
+    else                         snprintf(target, sizeof(target), "%s", m->host);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        /* Enfant : stderr écarté, il passerait sur l'UI */
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDERR_FILENO);
+            close(devnull);
+        }
+        dup2(sv[1], STDIN_FILENO);
+        dup2(sv[1], STDOUT_FILENO);
+        close(sv[0]);
+        close(sv[1]);
+        execlp("ssh", "ssh", "-T", "-o", timeout, "-o", "BatchMode=yes",
+               "-o", "ServerAliveInterval=15", "-p", port, target, command, (char *)NULL);
+        _exit(127);
+    }
+
+    close(sv[1]);
+    fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+    *fd = sv[0];
+    return pid;
+}
+
+/* --- Hôte simulé --- */
+
+typedef struct {
+    int latency_ms;
+    int jitter_ms;
+    int bw_kbps;        /* 0 = illimité */
+    int fail_pct;
+    int hang_pct;
+    int procs;
+} sim_params_t;
+
+#define SIM_MAX_PROCS  50000
+#define SIM_EPOCH_S    10       /* renouvellement d'une partie des PIDs */
+#define SIM_LIFETIME   20       /* un PID vit 20 époques : ~5 % de churn */
+#define SIM_CPUS       4
+
+/* Adresse "latency=80,jitter=20,bw=512,fail=5,hang=1,procs=2000" ;
+ * "-" ou vide : valeurs par défaut */
+static int sim_parse(const char *spec, sim_params_t *p)
+{
+    p->latency_ms = 50;
+    p->jitter_ms = 10;
+    p->bw_kbps = 0;
+    p->fail_pct = 0;
+    p->hang_pct = 0;
+    p->procs = 300;
+
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", spec ? spec : "");
+    if (strcmp(buf, "-") == 0) return 0;
+
+    char *saveptr = NULL;
+    for (char *kv = strtok_r(buf, ",", &saveptr); kv; kv = strtok_r(NULL, ",", &saveptr)) {
+        char *eq = strchr(kv, '=');
+        if (!eq) return -1;
+        *eq = '\0';
+        char *end;
+        long v = strtol(eq + 1, &end, 10);
+        if (end == eq + 1 || *end != '\0' || v < 0) return -1;
+
+        if (strcmp(kv, "latency") == 0)     p->latency_ms = (int)v;
+        else if (strcmp(kv, "jitter") == 0) p->jitter_ms = (int)v;
+        else if (strcmp(kv, "bw") == 0)     p->bw_kbps = (int)v;
+        else if (strcmp(kv, "fail") == 0)   p->fail_pct = (int)v;
+        else if (strcmp(kv, "hang") == 0)   p->hang_pct = (int)v;
+        else if (strcmp(kv, "procs") == 0)  p->procs = (int)v;
+        else return -1;
+    }
+    if (p->fail_pct > 100 || p->hang_pct > 100 || p->procs < 1 || p->procs > SIM_MAX_PROCS) {
+        return -1;
+    }
+    return 0;
+}
+
+static int sim_open(const remotemachine_t *m)
+{
+    sim_params_t p;
+    if (sim_parse(m->host, &p) != 0) {
+        fprintf(stderr, "%s: invalid sim parameters '%s'\n", m->name, m->host);
+        return -1;
+    }
+    return 0;
+}
+
+static unsigned int mix(unsigned int x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static unsigned int name_seed(const char *s)
+{
+    unsigned int h = 2166136261U;
+    for (; *s; ++s) h = (h ^ (unsigned char)*s) * 16777619U;
+    return h;
+}
+
+static double sim_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void sim_sleep_ms(long ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    while (ms > 0 && nanosleep(&ts, &ts) != 0) { }
+}
+
+/* Génération du PID occupant l'emplacement slot : les emplacements
+ * changent à des époques décalées, la table reste cohérente d'un appel à
+ * l'autre sans état */
+static int sim_generation(unsigned int seed, int slot, long epoch)
+{
+    long shift = (long)(mix(seed ^ (unsigned int)slot) % SIM_LIFETIME);
+    return (int)(((epoch + shift) / SIM_LIFETIME) % 1000);
+}
+
+static int sim_pid(const sim_params_t *p, int slot, int gen)
+{
+    return 1000 + slot + p->procs * gen;
+}
+
+/* tally : nombre de processus R, S, D, Z, pour la ligne "tasks" */
+static void sim_write_ps(FILE *out, const sim_params_t *p, unsigned int seed, long epoch,
+                         int tally[4])
+{
+    static const char *users[] = { "root", "www-data", "postgres", "daemon", "app" };
+    static const char *comms[] = { "nginx", "postgres", "python3", "java", "sshd",
+                                   "cron", "redis-server", "node", "kworker/0:1" };
+
+    fprintf(out, "    PID USER     %%CPU %%MEM STAT COMMAND\n");
+    for (int i = 0; i < p->procs; ++i) {
+        int gen = sim_generation(seed, i, epoch);
+        unsigned int h = mix(seed ^ (unsigned int)(i * 7919) ^ (unsigned int)gen);
+        /* Peu de processus actifs (2 %), comme sur un vrai hôte */
+        unsigned int r = mix(h ^ (unsigned int)epoch);
+        double cpu = (r % 100 < 2) ? (double)((r >> 8) % 500) / 10.0 : (double)((r >> 8) % 10) / 10.0;
+        char state = (cpu > 50.0) ? 'R' : (h % 200 == 0) ? 'D' : (h % 500 == 1) ? 'Z' : 'S';
+        tally[state == 'R' ? 0 : state == 'S' ? 1 : state == 'D' ? 2 : 3]++;
+
+        fprintf(out, "%7d %-8s %4.1f %4.1f %c    %s\n",
+                sim_pid(p, i, gen), users[h % 5], cpu, (double)(h % 10) / 100.0,
+                state, comms[(h >> 8) % 9]);
+    }
+}
+
+/* Mêmes lignes que HOST_SAMPLE_COMMAND ; compteurs CPU croissants
+ * dérivés de l'horloge, charge entre 30 et 50 % */
+static void sim_write_host(FILE *out, const sim_params_t *p, unsigned int seed, double now,
+                           const int tally[4])
+{
+    unsigned long long tick_total = 0, tick_busy = 0;
+    char lines[SIM_CPUS][96];
+    for (int c = 0; c < SIM_CPUS; ++c) {
+        double t = now + (double)(mix(seed + (unsigned int)c) % 60);
+        double tri = t - 60.0 * (double)(long)(t / 60.0) - 30.0;
+        unsigned long long total = (unsigned long long)(t * 100.0);
+        unsigned long long busy = (unsigned long long)(t * 40.0 + (tri < 0 ? -tri : tri) * 10.0);
+        tick_total += total;
+        tick_busy += busy;
+        snprintf(lines[c], sizeof(lines[c]), "cpu%d %llu 0 0 %llu 0 0 0 0 0 0",
+                 c, busy, total - busy);
+    }
+    fprintf(out, "cpu  %llu 0 0 %llu 0 0 0 0 0 0\n", tick_busy, tick_total - tick_busy);
+    for (int c = 0; c < SIM_CPUS; ++c) fprintf(out, "%s\n", lines[c]);
+
+    unsigned int h = mix(seed ^ (unsigned int)(now / SIM_EPOCH_S));
+    fprintf(out, "MemTotal:       16384000 kB\n");
+    fprintf(out, "MemAvailable:   %u kB\n", 4000000U + h % 8000000U);
+    fprintf(out, "SwapTotal:       2097148 kB\n");
+    fprintf(out, "SwapFree:        %u kB\n", 1500000U + h % 500000U);
+    fprintf(out, "%.2f %.2f %.2f 2/%d %d\n",
+            1.0 + (double)(h % 200) / 100.0, 1.5, 1.4, p->procs, 1000 + p->procs);
+    fprintf(out, "/proc/pressure/cpu:some avg10=%.2f avg60=0.00 avg300=0.00 total=0\n",
+            (double)(h % 500) / 100.0);
+    fprintf(out, "/proc/pressure/memory:some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+    fprintf(out, "/proc/pressure/io:some avg10=%.2f avg60=0.00 avg300=0.00 total=0\n",
+            (double)(h % 300) / 100.0);
+    fprintf(out, "tasks %d %d %d %d %d 0\n", p->procs, tally[0], tally[1], tally[2], tally[3]);
+}
+
+/* Quatre tâches par processus, au format de /proc/PID/task/TID/stat */
+static void sim_write_threads(FILE *out, int pid, double now)
+{
+    for (int k = 0; k < 4; ++k) {
+        unsigned long long ticks = (unsigned long long)(now * 100.0) / (unsigned long long)(k + 2);
+        fprintf(out, "%d (worker-%d) S 1 %d %d 0 -1 0 0 0 0 0 %llu %llu\n",
+                pid + k, k, pid, pid, ticks / 2, ticks / 2);
+    }
+}
+
+/* Le PID fait-il partie de la table courante ? */
+static int sim_has_pid(const sim_params_t *p, unsigned int seed, long epoch, int pid)
+{
+    int off = pid - 1000;
+    if (off < 0) return 0;
+    int slot = off % p->procs;
+    return sim_generation(seed, slot, epoch) == off / p->procs;
+}
+
+/* Écrit la sortie sur stdout au débit configuré */
+static void sim_send(const sim_params_t *p, const char *buf, size_t len)
+{
+    size_t chunk = 4096;
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = (len - off < chunk) ? len - off : chunk;
+        for (size_t w = 0; w < n; ) {
+            ssize_t r = write(STDOUT_FILENO, buf + off + w, n - w);
+            if (r <= 0) return;
+            w += (size_t)r;
+        }
+        if (p->bw_kbps > 0) sim_sleep_ms((long)(n * 1000 / ((size_t)p->bw_kbps * 1024)));
+    }
+}
+
+/* Fils simulant un aller-retour : latence, échec (code 255 comme ssh) ou
+ * blocage, puis la sortie de gen */
+static pid_t sim_spawn(const remotemachine_t *m, const remote_request_t *req, int probe,
+                       const remote_signal_t *sigs, int n, int *fd)
+{
+    sim_params_t p;
+    if (sim_parse(m->host, &p) != 0) return -1;
+
+    pid_t pid = start_child(fd);
+    if (pid != 0) return pid;
+
+    /* Enfant */
+    double now = sim_now();
+    unsigned int seed = name_seed(m->name);
+    unsigned int roll = mix((unsigned int)getpid() ^ (unsigned int)(now * 1e6));
+
+    long delay = p.latency_ms;
+    if (p.jitter_ms > 0) delay += (long)(roll % (unsigned int)(2 * p.jitter_ms + 1)) - p.jitter_ms;
+    sim_sleep_ms(delay > 0 ? delay : 0);
+
+    roll = mix(roll);
+    if ((int)(roll % 100) < p.fail_pct) _exit(255);
+    roll = mix(roll);
+    if ((int)(roll % 100) < p.hang_pct) {
+        for (;;) pause();
+    }
+    if (probe) _exit(0);
+
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *out = open_memstream(&buf, &len);
+    if (!out) _exit(1);
+
+    long epoch = (long)(now / SIM_EPOCH_S);
+    if (sigs) {
+        for (int i = 0; i < n; ++i) {
+            fprintf(out, "@@rc %d %d\n", sigs[i].id, sim_has_pid(&p, seed, epoch, sigs[i].pid) ? 0 : 1);
+        }
+    } else {
+        /* Le filtre n'est pas poussé : il est appliqué à la réception */
+        int tally[4] = {0};
+        sim_write_ps(out, &p, seed, epoch, tally);
+        fprintf(out, HOST_MARKER "\n");
+        sim_write_host(out, &p, seed, now, tally);
+        if (req && req->thread_pid > 0) {
+            fprintf(out, THREADS_MARKER "\n");
+            sim_write_threads(out, req->thread_pid, now);
+        }
+    }
+    fclose(out);
+    sim_send(&p, buf, len);
+    _exit(0);
+}
+
+static pid_t sim_run_collector(const remotemachine_t *m, const remote_request_t *req,
+                               int probe, int *fd)
+{
+    return sim_spawn(m, req, probe, NULL, 0, fd);
+}
+
+static pid_t sim_send_signals(const remotemachine_t *m, const remote_signal_t *sigs, int n,
+                              int *fd)
+{
+    return sim_spawn(m, NULL, 0, sigs, n, fd);
+}
+
+/* --- Table des transports --- */
+
+static const transport_t transports[] = {
+    { "ssh",   NULL,     ssh_run_collector,   ssh_send_signals   },
+    { "local", NULL,     local_run_collector, local_send_signals },
+    { "sim",   sim_open, sim_run_collector,   sim_send_signals   },
+};
+
+const transport_t *transport_find(const char *type)
+{
+    if (!type || type[0] == '\0') return &transports[0];
+    for (size_t i = 0; i < sizeof(transports) / sizeof(transports[0]); ++i) {
+        if (strcmp(transports[i].name, type) == 0) return &transports[i];
+    }
+    return NULL;
+}
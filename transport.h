@@ -0,0 +1,53 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <sys/types.h>
+#include "network.h"
+
+/*
+ * Transports des hôtes distants, choisis par le champ type de la
+ * configuration :
+ *
+ *   ssh    commandes lancées par ssh (défaut)
+ *   local  mêmes commandes par sh sur cette machine, sans réseau
+ *   sim    hôte simulé : table de processus synthétique servie par un
+ *          processus fils, avec latence, débit et pannes injectés.
+ *          L'adresse porte les paramètres :
+ *            latency=MS,jitter=MS,bw=KO/s,fail=%,hang=%,procs=N
+ *          par ex. "sim1:latency=80,fail=5,procs=2000:0:-:-:sim"
+ *
+ * Chaque opération démarre un processus fils dont la sortie est lue sans
+ * bloquer (fetch_remote_poll, remote_exec_poll) et retourne son pid.
+ */
+
+/* Sections qui suivent ps dans la sortie d'une collecte */
+#define HOST_MARKER    "@@host"
+#define THREADS_MARKER "@@threads"
+
+typedef struct {
+    const char *name;
+
+    /* Vérifie la configuration de l'hôte (NULL : rien à vérifier) */
+    int (*open)(const remotemachine_t *m);
+
+    /* Collecte : ps, puis le résumé de l'hôte et les tâches demandées.
+     * probe : seulement tester la connexion. */
+    pid_t (*run_collector)(const remotemachine_t *m, const remote_request_t *req,
+                           int probe, int *fd);
+
+    /* Lot de signaux : une ligne "@@rc ID CODE" par signal */
+    pid_t (*send_signals)(const remotemachine_t *m, const remote_signal_t *sigs, int n,
+                          int *fd);
+} transport_t;
+
+/* type "" : ssh. NULL si inconnu. */
+const transport_t *transport_find(const char *type);
+
+/* Session ssh vers m exécutant command, entrée et sortie sur la socket
+ * *fd (relais, --via). Retourne le pid de ssh, -1 en cas d'erreur. */
+pid_t transport_open_stream(const remotemachine_t *m, const char *command, int *fd);
+
+/* "TERM", "KILL"... NULL si le signal n'est pas supporté */
+const char *transport_signal_name(int signum);
+
+#endif
@@ -1,321 +1,722 @@
-#include "ui.h"
-#include <string.h>
-
-static void draw_header(int width)
-{
-    // Ligne 0 est réservée aux onglets (ne pas toucher ici)
-
-    // Ligne 1 : Le titre et la barre du haut
-    mvhline(1, 0, '-', width); 
-    mvprintw(1, 2, " Process Manager (Network version) ");
-    
-    // Ligne 2 : Les colonnes (PID, USER...)
-    mvprintw(2, 0, "PID      USER            %%CPU   %%MEM  S COMMAND");
-    
-    // Ligne 3 : Barre de séparation sous les colonnes
-    mvhline(3, 0, '-', width);
-}
-
-static void draw_tabs(ui_context_t *ctx, int width)
-{
-    // Efface la ligne du haut
-    mvhline(0, 0, ' ', width);
-    
-    // Affiche le nombre d'onglets pour le débogage (en haut à droite)
-    mvprintw(0, width - 20, "Tabs: %d | Idx: %d", ctx->tab_count, ctx->current_tab_index);
-
-    for (int i = 0; i < ctx->tab_count; ++i) {
-        // Espace plus large entre les onglets
-        int x = 2 + i * 25; 
-        
-        if (i == ctx->current_tab_index) {
-            // Onglet ACTIF : Gras + Reverse + Flèches
-            attron(A_REVERSE | A_BOLD);
-            mvprintw(0, x, " >> %s << ", ctx->tabs[i].hostname);
-            attroff(A_REVERSE | A_BOLD);
-        } else {
-            // Onglet INACTIF
-            mvprintw(0, x, " [%s] ", ctx->tabs[i].hostname);
-        }
-    }
-}
-
-void ui_init(void)
-{
-    initscr();
-    cbreak();
-    noecho();
-    keypad(stdscr, TRUE);
-    curs_set(0);
-}
-
-void ui_clean(void)
-{
-    endwin();
-}
-
-void ui_draw(ui_context_t *ctx)
-{
-    int height, width;
-    getmaxyx(stdscr, height, width);
-    clear();
-
-    draw_tabs(ctx, width);
-    draw_header(width);
-
-    if (ctx->tab_count == 0) {
-        mvprintw(4, 2, "No tabs.");
-        refresh();
-        return;
-    }
-
-    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
-
-    int list_top = 4;
-    int max_rows = height - list_top - 1;
-    if (max_rows < 1) max_rows = 1;
-
-    int start = ctx->scroll_offset;
-    int end = start + max_rows;
-    if (end > tab->process_count) end = tab->process_count;
-
-    for (int i = start; i < end; ++i) {
-        int y = list_top + (i - start);
-        process_info_t *p = &tab->processes[i];
-
-        if (i == tab->selected_proc_index) {
-            attron(A_REVERSE);
-        }
-
-        mvprintw(y, 0, "%-8d %-15s %6.2f %6.2f %2c %-s",
-                 p->pid,
-                 p->user,
-                 p->cpu_usage,
-                 p->mem_usage,
-                 p->state ? p->state : ' ',
-                 p->command);
-
-        if (i == tab->selected_proc_index) {
-            attroff(A_REVERSE);
-        }
-    }
-
-    mvhline(height - 1, 0, '-', width);
-    mvprintw(height - 1, 2,
-             "F1:HELP F2/F3:TABS F4:SEARCH F5:STOP F6:TERM F7:KILL F8:CONT F9:REFRESH q:quit");
-    refresh();
-}
-
-void ui_show_help_screen(const ui_context_t *ctx)
-{
-    (void)ctx;
-
-    int height, width;
-    getmaxyx(stdscr, height, width);
-
-    int box_height = 13;
-    int box_width = (width > 70) ? 70 : width - 4;
-    if (box_width < 40) {
-        box_width = width - 2;
-    }
-
-    int start_y = (height - box_height) / 2;
-    if (start_y < 0) start_y = 0;
-    int start_x = (width - box_width) / 2;
-    if (start_x < 0) start_x = 0;
-
-    WINDOW *win = newwin(box_height, box_width, start_y, start_x);
-    if (win == NULL) {
-        return;
-    }
-
-    box(win, 0, 0);
-    mvwprintw(win, 1, 2, "Help - Keyboard Shortcuts");
-    mvwprintw(win, 3, 2, "F1 : show this help");
-    mvwprintw(win, 4, 2, "F2/F3 : change tab");
-    mvwprintw(win, 5, 2, "F4 : search a process by name (command)");
-    mvwprintw(win, 6, 2, "F5 : send SIGSTOP (pause the process)");
-    mvwprintw(win, 7, 2, "F6 : send SIGTERM (graceful termination)");
-    mvwprintw(win, 8, 2, "F7 : send SIGKILL (immediate kill)");
-    mvwprintw(win, 9, 2, "F8 : send SIGCONT (resume)");
-    mvwprintw(win, 10, 2, "F9 : refresh the process list");
-    mvwprintw(win, box_height - 2, 2, "Press any key to close help...");
-    wrefresh(win);
-    wgetch(win);
-    delwin(win);
-}
-
-void ui_search_process_by_name(ui_context_t *ctx)
-{
-    if (!ctx || ctx->tab_count == 0 || !ctx->tabs) {
-        return;
-    }
-
-    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
-    if (tab->process_count == 0) {
-        return;
-    }
-
-    int height, width;
-    getmaxyx(stdscr, height, width);
-
-    char query[64];
-    memset(query, 0, sizeof(query));
-    int len = 0;
-    int ch;
-    const char *prompt = "Search (command) : ";
-
-    curs_set(1);
-    while (1) {
-        move(height - 1, 0);
-        clrtoeol();
-        mvprintw(height - 1, 2, "%s%s", prompt, query);
-        move(height - 1, 2 + (int)strlen(prompt) + len);
-        refresh();
-
-        ch = getch();
-        if (ch == '\n' || ch == '\r') {
-            break;
-        } else if (ch == 27) {
-            query[0] = '\0';
-            break;
-        } else if (ch == KEY_BACKSPACE || ch == 127 || ch == '\b') {
-            if (len > 0) {
-                len--;
-                query[len] = '\0';
-            }
-        } else if (ch >= 32 && ch <= 126 && len < (int)sizeof(query) - 1) {
-            query[len++] = (char)ch;
-            query[len] = '\0';
-        }
-    }
-    curs_set(0);
-
-    if (query[0] == '\0') {
-        return;
-    }
-
-    int found = -1;
-    for (int i = 0; i < tab->process_count; ++i) {
-        const char *cmd = tab->processes[i].command;
-        if (cmd && strstr(cmd, query) != NULL) {
-            found = i;
-            break;
-        }
-    }
-
-    if (found != -1) {
-        tab->selected_proc_index = found;
-
-        int list_top = 3;
-        int max_rows = height - list_top - 1;
-        if (max_rows < 1) max_rows = 1;
-
-        if (found < ctx->scroll_offset) {
-            ctx->scroll_offset = found;
-        } else if (found >= ctx->scroll_offset + max_rows) {
-            ctx->scroll_offset = found - max_rows + 1;
-        }
-
-        if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
-    } else {
-        move(height - 2, 0);
-        clrtoeol();
-        mvprintw(height - 2, 2,
-                 "No process contains \"%s\" in its command.", query);
-        refresh();
-    }
-}
-
-int ui_input(ui_context_t *ctx)
-{
-    int ch = getch();
-
-    if (ctx->tab_count == 0) {
-        if (ch == 'q' || ch == KEY_F(10)) {
-            ctx->running = 0;
-        }
-        return 0;
-    }
-
-    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
-
-    int height, width;
-    getmaxyx(stdscr, height, width);
-
-    int list_top = 3;
-    int max_rows = height - list_top - 1;
-    if (max_rows < 1) max_rows = 1;
-
-    switch (ch) {
-    case 'q':
-    case KEY_F(10):
-        ctx->running = 0;
-        break;
-
-    case KEY_F(2):
-        ctx->current_tab_index++;
-        if (ctx->current_tab_index >= ctx->tab_count) {
-            ctx->current_tab_index = 0;
-        }
-        ctx->scroll_offset = 0;
-        break;
-
-    case KEY_F(3):
-        ctx->current_tab_index--;
-        if (ctx->current_tab_index < 0) {
-            ctx->current_tab_index = ctx->tab_count - 1;
-        }
-        ctx->scroll_offset = 0;
-        break;
-
-    case KEY_DOWN:
-        if (tab->selected_proc_index < tab->process_count - 1) {
-            tab->selected_proc_index++;
-            if (tab->selected_proc_index >= ctx->scroll_offset + max_rows) {
-                ctx->scroll_offset++;
-            }
-        }
-        break;
-
-    case KEY_UP:
-        if (tab->selected_proc_index > 0) {
-            tab->selected_proc_index--;
-            if (tab->selected_proc_index < ctx->scroll_offset) {
-                ctx->scroll_offset--;
-                if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
-            }
-        }
-        break;
-
-    case KEY_NPAGE:
-        tab->selected_proc_index += max_rows;
-        if (tab->selected_proc_index >= tab->process_count) {
-            tab->selected_proc_index = tab->process_count - 1;
-        }
-        ctx->scroll_offset = tab->selected_proc_index - max_rows + 1;
-        if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
-        break;
-
-    case KEY_PPAGE:
-        tab->selected_proc_index -= max_rows;
-        if (tab->selected_proc_index < 0) tab->selected_proc_index = 0;
-        ctx->scroll_offset = tab->selected_proc_index;
-        if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
-        break;
-
-    case KEY_F(1):
-    case KEY_F(4):
-    case KEY_F(5):
-    case KEY_F(6):
-    case KEY_F(7):
-    case KEY_F(8):
-    case KEY_F(9):
-        return ch;
-
-    default:
-        break;
-    }
-
-    return 0;
-}
+#include "ui.h"
+#include "fleet.h"
+#include "cgroup.h"
+#include "columns.h"
+#include <string.h>
+
+/* Lignes du résumé de l'hôte sous le titre (pas pour "All hosts") */
+static int summary_lines(const machine_tab_t *tab)
+{
+    return (tab && tab->kind != TAB_FLEET && tab->summary.valid) ? 2 : 0;
+}
+
+/* Première ligne de la liste de processus */
+static int list_top_row(const ui_context_t *ctx)
+{
+    if (ctx->tab_count == 0) return 4;
+    return 4 + summary_lines(&ctx->tabs[ctx->current_tab_index]);
+}
+
+static void draw_summary(const machine_tab_t *tab, int y, int width)
+{
+    const host_summary_t *s = &tab->summary;
+    const host_sample_t *h = &s->last;
+
+    // CPU global, puis une case par CPU : ' ' inactif .. '@' saturé
+    static const char levels[] = " .:-=+*#%@";
+    if (s->cpu_pct[0] >= 0.0) mvprintw(y, 1, "CPU %5.1f%% [", s->cpu_pct[0]);
+    else                      mvprintw(y, 1, "CPU    --  [");
+    int room = width / 2;
+    for (int i = 1; i <= h->cpu_count && i <= room; ++i) {
+        double pct = s->cpu_pct[i];
+        int level = pct < 0.0 ? 0 : (int)(pct / 10.0);
+        if (level > 9) level = 9;
+        addch(pct < 0.0 ? '?' : levels[level]);
+    }
+    printw("%s]", h->cpu_count > room ? "+" : "");
+
+    if (h->load[0] >= 0.0) {
+        printw("  load %.2f %.2f %.2f", h->load[0], h->load[1], h->load[2]);
+    }
+    if (h->psi[HOST_PSI_CPU] >= 0.0 || h->psi[HOST_PSI_MEM] >= 0.0 || h->psi[HOST_PSI_IO] >= 0.0) {
+        printw("  PSI cpu %.1f mem %.1f io %.1f",
+               h->psi[HOST_PSI_CPU] < 0.0 ? 0.0 : h->psi[HOST_PSI_CPU],
+               h->psi[HOST_PSI_MEM] < 0.0 ? 0.0 : h->psi[HOST_PSI_MEM],
+               h->psi[HOST_PSI_IO] < 0.0 ? 0.0 : h->psi[HOST_PSI_IO]);
+    }
+
+    // Mémoire, swap, états des processus
+    double gib = 1024.0 * 1024.0;
+    if (h->mem_total_kb > 0) {
+        unsigned long long used = h->mem_total_kb - h->mem_avail_kb;
+        mvprintw(y + 1, 1, "Mem %.1f/%.1fG (%.0f%%)", used / gib, h->mem_total_kb / gib,
+                 (double)used * 100.0 / (double)h->mem_total_kb);
+    } else {
+        mvprintw(y + 1, 1, "Mem --");
+    }
+    if (h->swap_total_kb > 0) {
+        printw("  Swap %.1f/%.1fG", (h->swap_total_kb - h->swap_free_kb) / gib,
+               h->swap_total_kb / gib);
+    } else {
+        printw("  Swap --");
+    }
+    printw("  Tasks %d: %d run, %d sleep, ", s->tasks, s->running, s->sleeping);
+    if (s->disk > 0) attron(A_BOLD);
+    printw("%d D", s->disk);
+    if (s->disk > 0) attroff(A_BOLD);
+    printw(", ");
+    if (s->zombie > 0) attron(A_BOLD);
+    printw("%d zombie", s->zombie);
+    if (s->zombie > 0) attroff(A_BOLD);
+    if (s->stopped > 0) printw(", %d stopped", s->stopped);
+}
+
+/* Retourne la première ligne de la liste */
+static int draw_header(const ui_context_t *ctx, int width)
+{
+    // Ligne 0 est réservée aux onglets (ne pas toucher ici)
+
+    // Ligne 1 : Le titre et la barre du haut
+    mvhline(1, 0, '-', width); 
+    mvprintw(1, 2, " Process Manager (Network version) ");
+
+    // État de connexion de l'hôte distant affiché
+    if (ctx->tab_count > 0 && ctx->tabs[ctx->current_tab_index].health) {
+        char health[96];
+        remote_health_describe(ctx->tabs[ctx->current_tab_index].health,
+                               health, sizeof(health));
+        mvprintw(1, 40, " %s ", health);
+    }
+    
+    // Filtre actif (appliqué à la collecte, aussi côté distant)
+    if (process_query_active(&ctx->query)) {
+        char filter[128];
+        process_query_format(&ctx->query, filter, sizeof(filter));
+        mvprintw(1, width / 2, " filter: %s ", filter);
+    }
+
+    // Résumé de l'hôte, puis les colonnes (PID, USER...)
+    const machine_tab_t *current = ctx->tab_count > 0 ? &ctx->tabs[ctx->current_tab_index] : NULL;
+    int extra = summary_lines(current);
+    if (extra > 0) draw_summary(current, 2, width);
+    int cols_row = 2 + extra;
+
+    if (ctx->group_mode != GROUP_NONE) {
+        mvprintw(1, width - 34, " group: %s  sort: %s ",
+                 group_mode_name(ctx->group_mode),
+                 group_sort_name(ctx->group_sort));
+        if (ctx->group_mode == GROUP_BY_CGROUP) {
+            mvprintw(cols_row, 0, "   COUNT     %%CPU     %%MEM  CG-%%CPU  CG-MEM  CGROUP");
+        } else {
+            mvprintw(cols_row, 0, "   COUNT     %%CPU     %%MEM  %s",
+                     ctx->group_mode == GROUP_BY_USER ? "USER" : "COMMAND");
+        }
+    } else {
+        const machine_tab_t *tab = current;
+        char columns[256];
+        columns_format_header(ctx->columns, columns, sizeof(columns));
+        if (tab && tab->kind == TAB_FLEET) {
+            mvprintw(1, width - 24, " top %d by %s ",
+                     tab->process_count,
+                     ctx->fleet_key == PROC_SORT_MEM ? "%MEM" : "%CPU");
+            mvprintw(cols_row, 0, "HOST         %s", columns);
+        } else {
+            mvprintw(cols_row, 0, "%s", columns);
+        }
+    }
+    
+    // Barre de séparation sous les colonnes, avec les totaux
+    mvhline(cols_row + 1, 0, '-', width);
+    if (ctx->tab_count > 0) {
+        const machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
+        int procs = tab->hot.count;
+        double cpu = tab->hot.cpu_total;
+        double mem = tab->hot.mem_total;
+        if (tab->kind == TAB_FLEET) {
+            // Toute la flotte, pas seulement le top-K affiché
+            procs = 0;
+            cpu = mem = 0.0;
+            for (int t = 0; t < ctx->tab_count; ++t) {
+                if (ctx->tabs[t].kind == TAB_FLEET) continue;
+                procs += ctx->tabs[t].hot.count;
+                cpu += ctx->tabs[t].hot.cpu_total;
+                mem += ctx->tabs[t].hot.mem_total;
+            }
+        }
+        mvprintw(cols_row + 1, 2, " %d procs  %%CPU %.1f  %%MEM %.1f ", procs, cpu, mem);
+    }
+    return cols_row + 2;
+}
+
+static void draw_tabs(ui_context_t *ctx, int width)
+{
+    // Efface la ligne du haut
+    mvhline(0, 0, ' ', width);
+    
+    // Affiche le nombre d'onglets pour le débogage (en haut à droite)
+    mvprintw(0, width - 20, "Tabs: %d | Idx: %d", ctx->tab_count, ctx->current_tab_index);
+
+    // Fenêtre d'onglets visibles, décalée pour garder l'onglet actif à l'écran
+    int visible = (width - 24) / 25;
+    if (visible < 1) visible = 1;
+    int first = 0;
+    if (ctx->current_tab_index >= visible) {
+        first = ctx->current_tab_index - visible + 1;
+    }
+    int last = first + visible;
+    if (last > ctx->tab_count) last = ctx->tab_count;
+
+    for (int i = first; i < last; ++i) {
+        // Espace plus large entre les onglets
+        int x = 2 + (i - first) * 25;
+        
+        // Hôte injoignable : marqué d'un '!'
+        const char *mark = (ctx->tabs[i].health &&
+                            ctx->tabs[i].health->state == HOST_DOWN) ? "!" : "";
+
+        if (i == ctx->current_tab_index) {
+            // Onglet ACTIF : Gras + Reverse + Flèches
+            attron(A_REVERSE | A_BOLD);
+            mvprintw(0, x, " >> %s%s << ", ctx->tabs[i].hostname, mark);
+            attroff(A_REVERSE | A_BOLD);
+        } else {
+            // Onglet INACTIF
+            mvprintw(0, x, " [%s%s] ", ctx->tabs[i].hostname, mark);
+        }
+    }
+}
+
+static void draw_process_row(int y, const ui_context_t *ctx,
+                             machine_tab_t *tab, int idx, const char *indent)
+{
+    process_info_t *p = &tab->processes[idx];
+    char host[16] = "";
+    char row[512];
+
+    if (tab->kind == TAB_FLEET && tab->origin) {
+        snprintf(host, sizeof(host), "%-12.12s ", ctx->tabs[tab->origin[idx]].hostname);
+    }
+
+    /* Colonnes coûteuses (FDs, cmdline) : lues seulement pour les lignes
+     * affichées, une fois par snapshot. PSS / USS / swap viennent du cache,
+     * relu en tâche de fond. */
+    const machine_tab_t *src = (tab->kind == TAB_FLEET && tab->origin)
+                               ? &ctx->tabs[tab->origin[idx]] : tab;
+    if (src->kind == TAB_LOCAL) {
+        unsigned needs = columns_needs(ctx->columns, 1);
+        process_fill_extra(p, needs & ~PROC_NEED_SMAPS);
+        if (needs & PROC_NEED_SMAPS) smaps_cache_fill(ctx->smaps, p, 1);
+    }
+
+    columns_format_row(ctx->columns, p, row, sizeof(row));
+    /* Pas de retour à la ligne sur les commandes longues */
+    if (p->alert) attron(A_BOLD);
+    mvprintw(y, 0, "%s%s%.*s", indent, host,
+             getmaxx(stdscr) - (int)(strlen(indent) + strlen(host)), row);
+    if (p->alert) attroff(A_BOLD);
+}
+
+static void draw_group_line(int y, const ui_context_t *ctx,
+                            machine_tab_t *tab, const group_line_t *line)
+{
+    if (line->proc >= 0) {
+        draw_process_row(y, ctx, tab, line->proc, "      ");
+        return;
+    }
+
+    const process_group_t *g = &tab->groups->groups[line->group];
+    /* Les totaux incrémentaux peuvent dériver légèrement sous zéro */
+    double cpu = g->cpu_total < 0.0 ? 0.0 : g->cpu_total;
+    double mem = g->mem_total < 0.0 ? 0.0 : g->mem_total;
+    if (tab->groups->mode == GROUP_BY_CGROUP) {
+        /* Compteurs du cgroup lui-même (cpu.stat, memory.current) */
+        const cgroup_info_t *cg = cgroup_get(g->cgroup_id);
+        mvprintw(y, 0, "%s %5d %8.2f %8.2f %7.1f %6.0fM  %-s",
+                 g->expanded ? "[-]" : "[+]",
+                 g->count, cpu, mem,
+                 cg ? cg->cpu_pct : 0.0,
+                 cg ? (double)cg->memory_current / (1024.0 * 1024.0) : 0.0,
+                 g->key);
+        return;
+    }
+
+    mvprintw(y, 0, "%s %5d %8.2f %8.2f  %-s",
+             g->expanded ? "[-]" : "[+]",
+             g->count, cpu, mem, g->key);
+}
+
+/* Sélection courante et nombre de lignes, selon le mode d'affichage */
+static int *tab_selection(machine_tab_t *tab, int *count)
+{
+    if (tab->groups) {
+        *count = tab->groups->line_count;
+        return &tab->groups->selected_line;
+    }
+    *count = tab->process_count;
+    return &tab->selected_proc_index;
+}
+
+static void set_group_mode(ui_context_t *ctx, group_mode_t mode)
+{
+    ctx->group_mode = mode;
+    ctx->scroll_offset = 0;
+
+    for (int i = 0; i < ctx->tab_count; ++i) {
+        machine_tab_t *tab = &ctx->tabs[i];
+        group_table_free(tab->groups);
+        tab->groups = NULL;
+
+        if (mode == GROUP_NONE) continue;
+
+        tab->groups = group_table_create(mode);
+        if (!tab->groups) continue;
+        tab->groups->sort = ctx->group_sort;
+        group_table_update(tab->groups, tab->processes, tab->process_count);
+    }
+}
+
+void ui_tab_updated(machine_tab_t *tab)
+{
+    if (!tab) return;
+    hot_columns_build(&tab->hot, tab->processes, tab->process_count);
+    if (tab->groups) {
+        group_table_update(tab->groups, tab->processes, tab->process_count);
+    }
+}
+
+int ui_selected_index(const ui_context_t *ctx)
+{
+    if (!ctx || ctx->tab_count == 0 || !ctx->tabs) return -1;
+
+    const machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
+    int idx = tab->selected_proc_index;
+
+    if (tab->groups) {
+        const group_table_t *gt = tab->groups;
+        if (gt->selected_line < 0 || gt->selected_line >= gt->line_count) return -1;
+        idx = gt->lines[gt->selected_line].proc;
+    }
+
+    if (idx < 0 || idx >= tab->process_count) return -1;
+    return idx;
+}
+
+int ui_selected_pid(const ui_context_t *ctx)
+{
+    int idx = ui_selected_index(ctx);
+    if (idx < 0) return -1;
+    return ctx->tabs[ctx->current_tab_index].processes[idx].pid;
+}
+
+void ui_init(void)
+{
+    initscr();
+    cbreak();
+    noecho();
+    keypad(stdscr, TRUE);
+    curs_set(0);
+    timeout(UI_TICK_MS);
+}
+
+void ui_clean(void)
+{
+    endwin();
+}
+
+void ui_draw(ui_context_t *ctx)
+{
+    int height, width;
+    getmaxyx(stdscr, height, width);
+    /* erase() plutôt que clear() : l'écran est redessiné à chaque tick */
+    erase();
+
+    draw_tabs(ctx, width);
+    int list_top = draw_header(ctx, width);
+
+    if (ctx->tab_count == 0) {
+        mvprintw(list_top, 2, "No tabs.");
+        refresh();
+        return;
+    }
+
+    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
+
+    int max_rows = height - list_top - 1;
+    if (max_rows < 1) max_rows = 1;
+
+    if (tab->kind == TAB_REMOTE && !tab->loaded) {
+        mvprintw(list_top, 2, "Loading %s...", tab->hostname);
+    }
+
+    int row_count;
+    int selected = *tab_selection(tab, &row_count);
+
+    /* Lignes de tâches sous la sélection, à garder visibles aussi */
+    int extra = 0;
+    if (!tab->groups && tab->threads && selected >= 0 && selected < tab->process_count &&
+        tab->processes[selected].pid == tab->expanded_pid) {
+        extra = tab->threads->count < max_rows / 2 ? tab->threads->count : max_rows / 2;
+    }
+
+    /* La sélection reste visible même si le snapshot a changé de taille */
+    if (selected >= row_count) selected = row_count - 1;
+    if (selected < ctx->scroll_offset) ctx->scroll_offset = selected;
+    if (selected + extra >= ctx->scroll_offset + max_rows) {
+        ctx->scroll_offset = selected + extra - max_rows + 1;
+    }
+    if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
+
+    int start = ctx->scroll_offset;
+    int bottom = list_top + max_rows;
+    int y = list_top;
+
+    for (int i = start; i < row_count && y < bottom; ++i, ++y) {
+        if (i == selected) {
+            attron(A_REVERSE);
+        }
+
+        if (tab->groups) {
+            draw_group_line(y, ctx, tab, &tab->groups->lines[i]);
+        } else {
+            draw_process_row(y, ctx, tab, i, "");
+        }
+
+        if (i == selected) {
+            attroff(A_REVERSE);
+        }
+
+        /* Tâches du processus déplié, sous sa ligne */
+        if (!tab->groups && tab->threads && tab->expanded_pid == tab->processes[i].pid) {
+            for (int k = 0; k < tab->threads->count && y + 1 < bottom; ++k) {
+                const thread_info_t *t = &tab->threads->threads[k];
+                ++y;
+                mvprintw(y, 0, "  `- %-8d %-10s %6.2f        %2c %-s",
+                         t->tid, "thread", t->cpu_usage,
+                         t->state ? t->state : ' ', t->name);
+            }
+        }
+    }
+
+    // Message ponctuel, sinon l'état des signaux envoyés à cet onglet
+    char actions[160];
+    if (ctx->status_msg[0] != '\0') {
+        mvprintw(height - 2, 2, "%s", ctx->status_msg);
+    } else if (action_queue_describe(ctx->actions, tab->kind == TAB_FLEET ? -1 : ctx->current_tab_index,
+                                     actions, sizeof(actions)) > 0) {
+        mvprintw(height - 2, 2, "Signals: %s", actions);
+    }
+
+    mvhline(height - 1, 0, '-', width);
+    mvprintw(height - 1, 2,
+             "F1:HELP F2/F3:TABS F4:SEARCH F5:STOP F6:TERM F7:KILL F8:CONT F9:REFRESH g:GROUP s:SORT k:TOP-K j:JUMP f:FILTER t:THREADS m:MEM q:quit");
+    refresh();
+}
+
+void ui_show_help_screen(const ui_context_t *ctx)
+{
+    (void)ctx;
+
+    int height, width;
+    getmaxyx(stdscr, height, width);
+
+    int box_height = 22;
+    int box_width = (width > 70) ? 70 : width - 4;
+    if (box_width < 40) {
+        box_width = width - 2;
+    }
+
+    int start_y = (height - box_height) / 2;
+    if (start_y < 0) start_y = 0;
+    int start_x = (width - box_width) / 2;
+    if (start_x < 0) start_x = 0;
+
+    WINDOW *win = newwin(box_height, box_width, start_y, start_x);
+    if (win == NULL) {
+        return;
+    }
+
+    box(win, 0, 0);
+    mvwprintw(win, 1, 2, "Help - Keyboard Shortcuts");
+    mvwprintw(win, 3, 2, "F1 : show this help");
+    mvwprintw(win, 4, 2, "F2/F3 : change tab");
+    mvwprintw(win, 5, 2, "F4 : search a process by name (command)");
+    mvwprintw(win, 6, 2, "F5 : send SIGSTOP (pause the process)");
+    mvwprintw(win, 7, 2, "F6 : send SIGTERM (graceful termination)");
+    mvwprintw(win, 8, 2, "F7 : send SIGKILL (immediate kill)");
+    mvwprintw(win, 9, 2, "F8 : send SIGCONT (resume)");
+    mvwprintw(win, 10, 2, "F9 : refresh the process list");
+    mvwprintw(win, 11, 2, "g : group by user / command / cgroup / none");
+    mvwprintw(win, 12, 2, "s : sort groups by %%CPU / %%MEM / count");
+    mvwprintw(win, 13, 2, "Enter : expand / collapse the selected group");
+    mvwprintw(win, 14, 2, "k : \"All hosts\" tab top-K by %%CPU / %%MEM");
+    mvwprintw(win, 15, 2, "j : jump to a host tab by name");
+    mvwprintw(win, 16, 2, "f : filter (user==x && cpu>5 || state==D sort=cpu top=N)");
+    mvwprintw(win, 17, 2, "t : show / hide the threads of the selected process");
+    mvwprintw(win, 18, 2, "[ ] / { } : replay, previous / next frame, -/+ 1 min");
+    mvwprintw(win, 19, 2, "m : memory detail, PSS / USS / swap (local, sort=pss)");
+    mvwprintw(win, box_height - 2, 2, "Press any key to close help...");
+    wrefresh(win);
+    wgetch(win);
+    delwin(win);
+}
+
+int ui_prompt(const char *prompt, char *buf, size_t size)
+{
+    int height, width;
+    getmaxyx(stdscr, height, width);
+    (void)width;
+
+    if (size == 0) return 0;
+    memset(buf, 0, size);
+    int len = 0;
+    int ch;
+
+    curs_set(1);
+    while (1) {
+        move(height - 1, 0);
+        clrtoeol();
+        mvprintw(height - 1, 2, "%s%s", prompt, buf);
+        move(height - 1, 2 + (int)strlen(prompt) + len);
+        refresh();
+
+        ch = getch();
+        if (ch == ERR) {
+            continue;
+        } else if (ch == '\n' || ch == '\r') {
+            break;
+        } else if (ch == 27) {
+            buf[0] = '\0';
+            len = 0;
+            break;
+        } else if (ch == KEY_BACKSPACE || ch == 127 || ch == '\b') {
+            if (len > 0) {
+                len--;
+                buf[len] = '\0';
+            }
+        } else if (ch >= 32 && ch <= 126 && len < (int)size - 1) {
+            buf[len++] = (char)ch;
+            buf[len] = '\0';
+        }
+    }
+    curs_set(0);
+
+    return len;
+}
+
+void ui_search_process_by_name(ui_context_t *ctx)
+{
+    if (!ctx || ctx->tab_count == 0 || !ctx->tabs) {
+        return;
+    }
+
+    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
+    if (tab->process_count == 0) {
+        return;
+    }
+
+    int height, width;
+    getmaxyx(stdscr, height, width);
+
+    char query[64];
+    ui_prompt("Search (command or expression) : ", query, sizeof(query));
+
+    if (query[0] == '\0') {
+        return;
+    }
+
+    /* Texte simple : sous-chaîne de la commande ; sinon expression de filtre */
+    filter_t f;
+    char err[64];
+    int is_expr = strpbrk(query, "<>=!~&|") != NULL;
+    if (is_expr && filter_compile(query, &f, err, sizeof(err)) != 0) {
+        snprintf(ctx->status_msg, sizeof(ctx->status_msg), "Invalid expression: %s", err);
+        return;
+    }
+
+    int found = -1;
+    for (int i = 0; i < tab->process_count; ++i) {
+        const process_info_t *p = &tab->processes[i];
+        if (is_expr ? filter_match(&f, p) : strstr(p->command, query) != NULL) {
+            found = i;
+            break;
+        }
+    }
+
+    if (found != -1) {
+        tab->selected_proc_index = found;
+
+        int list_top = list_top_row(ctx);
+        int max_rows = height - list_top - 1;
+        if (max_rows < 1) max_rows = 1;
+
+        if (found < ctx->scroll_offset) {
+            ctx->scroll_offset = found;
+        } else if (found >= ctx->scroll_offset + max_rows) {
+            ctx->scroll_offset = found - max_rows + 1;
+        }
+
+        if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
+    } else {
+        snprintf(ctx->status_msg, sizeof(ctx->status_msg),
+                 is_expr ? "No process matches \"%s\"." : "No process contains \"%s\" in its command.",
+                 query);
+    }
+}
+
+int ui_input(ui_context_t *ctx)
+{
+    int ch = getch();
+    if (ch == ERR) {
+        return 0;
+    }
+    ctx->status_msg[0] = '\0';
+
+    if (ctx->tab_count == 0) {
+        if (ch == 'q' || ch == KEY_F(10)) {
+            ctx->running = 0;
+        }
+        return 0;
+    }
+
+    machine_tab_t *tab = &ctx->tabs[ctx->current_tab_index];
+
+    int height, width;
+    getmaxyx(stdscr, height, width);
+
+    int list_top = list_top_row(ctx);
+    int max_rows = height - list_top - 1;
+    if (max_rows < 1) max_rows = 1;
+
+    int row_count;
+    int *sel = tab_selection(tab, &row_count);
+
+    switch (ch) {
+    case 'q':
+    case KEY_F(10):
+        ctx->running = 0;
+        break;
+
+    case KEY_F(2):
+        ctx->current_tab_index++;
+        if (ctx->current_tab_index >= ctx->tab_count) {
+            ctx->current_tab_index = 0;
+        }
+        ctx->scroll_offset = 0;
+        break;
+
+    case KEY_F(3):
+        ctx->current_tab_index--;
+        if (ctx->current_tab_index < 0) {
+            ctx->current_tab_index = ctx->tab_count - 1;
+        }
+        ctx->scroll_offset = 0;
+        break;
+
+    case 'g':
+        set_group_mode(ctx, (group_mode_t)((ctx->group_mode + 1) % GROUP_MODE_COUNT));
+        /* Les cgroups locaux ne sont lus que dans ce mode : recollecte */
+        if (ctx->group_mode == GROUP_BY_CGROUP) return 'g';
+        break;
+
+    case 's':
+        ctx->group_sort = (group_sort_t)((ctx->group_sort + 1) % GROUP_SORT_KEY_COUNT);
+        for (int i = 0; i < ctx->tab_count; ++i) {
+            if (!ctx->tabs[i].groups) continue;
+            ctx->tabs[i].groups->sort = ctx->group_sort;
+            group_table_build_lines(ctx->tabs[i].groups, ctx->tabs[i].process_count);
+        }
+        break;
+
+    case 't':
+        if (tab->kind == TAB_FLEET || tab->groups) {
+            snprintf(ctx->status_msg, sizeof(ctx->status_msg),
+                     "Threads: select a process in a host tab without grouping.");
+            break;
+        }
+        if (tab->selected_proc_index >= 0 && tab->selected_proc_index < tab->process_count) {
+            int pid = tab->processes[tab->selected_proc_index].pid;
+            tab->expanded_pid = (tab->expanded_pid == pid) ? 0 : pid;
+            return ch;
+        }
+        break;
+
+    case 'j':
+    case 'f':
+    case '[':
+    case ']':
+    case '{':
+    case '}':
+        return ch;
+
+    case 'k':
+        ctx->fleet_key = (ctx->fleet_key == PROC_SORT_MEM) ? PROC_SORT_CPU : PROC_SORT_MEM;
+        fleet_merge(ctx);
+        break;
+
+    case 'm':
+        /* Lu dans smaps_rollup : onglet local seulement */
+        ctx->columns ^= COLUMNS_MEM_DETAIL;
+        if (ctx->columns & COLUMNS_MEM_DETAIL) {
+            snprintf(ctx->status_msg, sizeof(ctx->status_msg),
+                     "Memory detail: PSS / USS / swap of the local processes.");
+        }
+        break;
+
+    case '\n':
+    case KEY_ENTER:
+        if (tab->groups) {
+            group_table_toggle_expand(tab->groups);
+            group_table_build_lines(tab->groups, tab->process_count);
+        }
+        break;
+
+    case KEY_DOWN:
+        if (*sel < row_count - 1) {
+            (*sel)++;
+            if (*sel >= ctx->scroll_offset + max_rows) {
+                ctx->scroll_offset++;
+            }
+        }
+        break;
+
+    case KEY_UP:
+        if (*sel > 0) {
+            (*sel)--;
+            if (*sel < ctx->scroll_offset) {
+                ctx->scroll_offset--;
+                if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
+            }
+        }
+        break;
+
+    case KEY_NPAGE:
+        *sel += max_rows;
+        if (*sel >= row_count) {
+            *sel = row_count - 1;
+        }
+        ctx->scroll_offset = *sel - max_rows + 1;
+        if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
+        break;
+
+    case KEY_PPAGE:
+        *sel -= max_rows;
+        if (*sel < 0) *sel = 0;
+        ctx->scroll_offset = *sel;
+        if (ctx->scroll_offset < 0) ctx->scroll_offset = 0;
+        break;
+
+    case KEY_F(1):
+    case KEY_F(4):
+    case KEY_F(5):
+    case KEY_F(6):
+    case KEY_F(7):
+    case KEY_F(8):
+    case KEY_F(9):
+        return ch;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
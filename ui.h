@@ -1,29 +1,89 @@
-#ifndef UI_H
-#define UI_H
-
-#include <ncurses.h>
-#include "process.h"
-
-typedef struct {
-    char hostname[64];
-    process_info_t *processes;
-    int process_count;
-    int selected_proc_index;
-} machine_tab_t;
-
-typedef struct {
-    machine_tab_t *tabs;
-    int tab_count;
-    int current_tab_index;
-    int running;
-    int scroll_offset;
-} ui_context_t;
-
-void ui_init(void);
-void ui_clean(void);
-void ui_draw(ui_context_t *ctx);
-int  ui_input(ui_context_t *ctx);
-void ui_show_help_screen(const ui_context_t *ctx);
-void ui_search_process_by_name(ui_context_t *ctx);
-
-#endif
+#ifndef UI_H
+#define UI_H
+
+#include <ncurses.h>
+#include "process.h"
+#include "filter.h"
+#include "group.h"
+#include "network.h"
+#include "hot.h"
+#include "action.h"
+#include "smaps.h"
+
+/* Délai de getch() : la boucle principale reprend la main pour les
+ * fetchs distants en arrière-plan même sans touche pressée */
+#define UI_TICK_MS 100
+
+typedef enum {
+    TAB_LOCAL = 0,
+    TAB_REMOTE,
+    TAB_FLEET           /* onglet virtuel "All hosts" */
+} tab_kind_t;
+
+typedef struct {
+    char hostname[64];
+    tab_kind_t kind;
+    int remote_index;           /* index dans remotes[] pour TAB_REMOTE */
+    int loaded;                 /* au moins un snapshot reçu */
+    int needs_fetch;            /* snapshot distant à (re)demander */
+    const host_health_t *health;    /* TAB_REMOTE : état de connexion */
+    process_info_t *processes;
+    int process_count;
+    int selected_proc_index;
+    group_table_t *groups;      /* NULL hors mode regroupement */
+
+    /* Top-K de l'onglet (indices dans processes, ordre décroissant),
+     * recalculé à chaque refresh de l'onglet et fusionné par l'onglet flotte */
+    int *rank_cpu;
+    int *rank_mem;
+    int rank_count;
+
+    int *origin;                /* TAB_FLEET : onglet d'origine de chaque ligne */
+
+    hot_columns_t hot;          /* pid, %CPU, %MEM, état de processes, en colonnes */
+    host_summary_t summary;     /* charge de l'hôte, affichée au-dessus de la liste */
+
+    int expanded_pid;           /* processus dont on affiche les tâches, 0 = aucun */
+    thread_list_t *threads;
+} machine_tab_t;
+
+typedef struct {
+    machine_tab_t *tabs;
+    int tab_count;
+    int current_tab_index;
+    int running;
+    int scroll_offset;
+    group_mode_t group_mode;
+    group_sort_t group_sort;
+    int fleet_tab_index;        /* -1 si pas d'onglet "All hosts" */
+    process_sort_t fleet_key;
+    int fleet_k;
+    char status_msg[128];       /* affiché au-dessus de la barre du bas */
+    process_query_t query;      /* filtre actif, poussé vers les distants */
+    unsigned long columns;      /* colonnes affichées (COL_BIT, columns.h) */
+    const action_queue_t *actions;  /* signaux récents, NULL hors session interactive */
+    smaps_cache_t *smaps;       /* PSS / USS / swap des lignes locales, NULL hors session interactive */
+} ui_context_t;
+
+void ui_init(void);
+void ui_clean(void);
+void ui_draw(ui_context_t *ctx);
+int  ui_input(ui_context_t *ctx);
+void ui_show_help_screen(const ui_context_t *ctx);
+void ui_search_process_by_name(ui_context_t *ctx);
+
+/* Saisie d'une ligne en bas de l'écran. Retourne sa longueur,
+ * 0 si vide ou annulée (Echap). */
+int  ui_prompt(const char *prompt, char *buf, size_t size);
+
+/* PID de la ligne sélectionnée dans l'onglet courant, -1 si aucun
+ * (par ex. entête de groupe sélectionnée). */
+int  ui_selected_pid(const ui_context_t *ctx);
+
+/* Index dans processes de la ligne sélectionnée, -1 si aucun */
+int  ui_selected_index(const ui_context_t *ctx);
+
+/* À appeler après remplacement de tab->processes (groupes, colonnes chaudes) */
+void ui_tab_updated(machine_tab_t *tab);
+
+#endif